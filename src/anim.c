@@ -0,0 +1,136 @@
+#include "anim.h"
+#include "utils.h"
+#include <string.h>
+
+static void anim_remove(AnimSystem* anim, u32 i);
+
+// One extra entry so sampling at t == 1.0 can read i0 + 1 without a bounds check
+static f32 ease_lut[EASE_COUNT][ANIM_LUT_SIZE + 1];
+static bool ease_lut_ready = false;
+
+void anim_init(AnimSystem* anim)
+{
+    memset(anim, 0, sizeof(*anim));
+
+    if (ease_lut_ready) {
+        return;
+    }
+
+    for (u32 i = 0; i <= ANIM_LUT_SIZE; ++i) {
+        f32 t = (f32)i / ANIM_LUT_SIZE;
+        f32 u = 1.0f - t;
+
+        ease_lut[EASE_LINEAR][i] = t;
+        ease_lut[EASE_IN_QUAD][i] = t * t;
+        ease_lut[EASE_OUT_QUAD][i] = 1.0f - u * u;
+        ease_lut[EASE_OUT_CUBIC][i] = 1.0f - u * u * u;
+        ease_lut[EASE_IN_OUT_CUBIC][i] = t < 0.5f ? 4.0f * t * t * t : 1.0f - 4.0f * u * u * u;
+    }
+
+    ease_lut_ready = true;
+}
+
+bool anim_tween(AnimSystem* anim, f32* target, const f32 from, const f32 to, const f32 duration, const Ease ease)
+{
+    // Restarting a tween on the same target replaces it rather than fighting over the value
+    anim_cancel(anim, target);
+
+    if (anim->count >= ANIM_MAX_TWEENS) {
+        util_error("No free tween slots (%d)", ANIM_MAX_TWEENS);
+        return false;
+    }
+
+    u32 i = anim->count++;
+    anim->target[i] = target;
+    anim->from[i] = from;
+    anim->delta[i] = to - from;
+    anim->elapsed[i] = 0.0f;
+    anim->inv_duration[i] = duration > 0.0f ? 1.0f / duration : 1e9f;
+    anim->t[i] = 0.0f;
+    anim->ease[i] = ease;
+
+    *target = from;
+
+    return true;
+}
+
+void anim_cancel(AnimSystem* anim, f32* target)
+{
+    for (u32 i = 0; i < anim->count; ++i) {
+        if (anim->target[i] == target) {
+            anim_remove(anim, i);
+            return;
+        }
+    }
+}
+
+bool anim_is_active(AnimSystem* anim, f32* target)
+{
+    for (u32 i = 0; i < anim->count; ++i) {
+        if (anim->target[i] == target) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void anim_update(AnimSystem* anim, const f64 dt)
+{
+    u32 n = anim->count;
+    f32 fdt = (f32)dt;
+
+    f32* restrict elapsed = anim->elapsed;
+    f32* restrict t = anim->t;
+    f32* restrict value = anim->value;
+    const f32* restrict inv_duration = anim->inv_duration;
+    const f32* restrict from = anim->from;
+    const f32* restrict delta = anim->delta;
+
+    for (u32 i = 0; i < n; ++i) {
+        elapsed[i] += fdt;
+        t[i] = fminf(elapsed[i] * inv_duration[i], 1.0f);
+    }
+
+    // Linear interpolation between neighbouring LUT entries; the only gather is the table read
+    for (u32 i = 0; i < n; ++i) {
+        f32 x = t[i] * ANIM_LUT_SIZE;
+        u32 i0 = (u32)x;
+        if (i0 > ANIM_LUT_SIZE - 1) i0 = ANIM_LUT_SIZE - 1;
+        f32 frac = x - (f32)i0;
+
+        const f32* lut = ease_lut[anim->ease[i]];
+        f32 e = lut[i0] + (lut[i0 + 1] - lut[i0]) * frac;
+
+        value[i] = from[i] + delta[i] * e;
+    }
+
+    for (u32 i = 0; i < n; ++i) {
+        *anim->target[i] = value[i];
+    }
+
+    // Walk backwards so swap-removal never skips an unvisited tween
+    for (u32 i = n; i-- > 0;) {
+        if (t[i] >= 1.0f) {
+            anim_remove(anim, i);
+        }
+    }
+}
+
+// ------------------------------------------------------------------------------------------------
+
+static void anim_remove(AnimSystem* anim, u32 i)
+{
+    u32 last = --anim->count;
+    if (i == last) {
+        return;
+    }
+
+    anim->target[i] = anim->target[last];
+    anim->from[i] = anim->from[last];
+    anim->delta[i] = anim->delta[last];
+    anim->elapsed[i] = anim->elapsed[last];
+    anim->inv_duration[i] = anim->inv_duration[last];
+    anim->t[i] = anim->t[last];
+    anim->value[i] = anim->value[last];
+    anim->ease[i] = anim->ease[last];
+}
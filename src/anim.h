@@ -0,0 +1,38 @@
+#ifndef ANIM_H_
+#define ANIM_H_
+
+#include "utils.h"
+
+#define ANIM_MAX_TWEENS 128
+#define ANIM_LUT_SIZE 256
+
+typedef enum {
+    EASE_LINEAR,
+    EASE_IN_QUAD,
+    EASE_OUT_QUAD,
+    EASE_OUT_CUBIC,
+    EASE_IN_OUT_CUBIC,
+    EASE_COUNT,
+} Ease;
+
+// Active tweens in parallel arrays. anim_update advances every tween by the same dt in a handful
+// of straight loops, then writes the results through `target`. Finished tweens are swap-removed.
+typedef struct {
+    u32 count;
+    f32* target[ANIM_MAX_TWEENS];
+    f32 from[ANIM_MAX_TWEENS];
+    f32 delta[ANIM_MAX_TWEENS];
+    f32 elapsed[ANIM_MAX_TWEENS];
+    f32 inv_duration[ANIM_MAX_TWEENS];
+    f32 t[ANIM_MAX_TWEENS];
+    f32 value[ANIM_MAX_TWEENS];
+    u8 ease[ANIM_MAX_TWEENS];
+} AnimSystem;
+
+void anim_init(AnimSystem* anim);
+bool anim_tween(AnimSystem* anim, f32* target, const f32 from, const f32 to, const f32 duration, const Ease ease);
+void anim_cancel(AnimSystem* anim, f32* target);
+bool anim_is_active(AnimSystem* anim, f32* target);
+void anim_update(AnimSystem* anim, const f64 dt);
+
+#endif // !ANIM_H_
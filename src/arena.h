@@ -1,28 +1,99 @@
 #ifndef ARENA_H_
 #define ARENA_H_
 
+#include "memreg.h"
 #include "utils.h"
 #include <stddef.h>
 #include <stdlib.h>
 
+// ASan can't see inside a single malloc'd block, so under -fsanitize=address the arena poisons
+// everything it hasn't handed out and leaves a poisoned red zone in front of every allocation.
+// Overruns from one allocation into the next, or use after a reset/rewind, then trap.
+#if defined(__SANITIZE_ADDRESS__)
+#define ARENA_ASAN 1
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer)
+#define ARENA_ASAN 1
+#endif
+#endif
+
+#ifdef ARENA_ASAN
+#include <sanitizer/asan_interface.h>
+#define ARENA_POISON(p, n) ASAN_POISON_MEMORY_REGION((p), (n))
+#define ARENA_UNPOISON(p, n) ASAN_UNPOISON_MEMORY_REGION((p), (n))
+#ifndef ARENA_REDZONE
+#define ARENA_REDZONE 16
+#endif
+#else
+#define ARENA_POISON(p, n) ((void)(p), (void)(n))
+#define ARENA_UNPOISON(p, n) ((void)(p), (void)(n))
+#ifndef ARENA_REDZONE
+#define ARENA_REDZONE 0
+#endif
+#endif
+
+// -DARENA_GUARD_PAGES backs each arena with its own mapping whose last page is PROT_NONE. The
+// capacity is rounded up to 64 bytes and the arena placed flush against that page, so the first
+// byte past its end faults immediately, even without ASan.
+#ifdef ARENA_GUARD_PAGES
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
 #define MB (1024 * 1024)
 
+// Extra capacity callers reserve for n allocations' red zones
+#define ARENA_SLACK(n_allocs) ((size_t)(n_allocs) * ARENA_REDZONE)
+
 typedef struct {
     unsigned char* base; // The start of the arena
     size_t cap;
     size_t offset;
+    i32 reg; // memreg entry, MEMREG_NONE if untracked
+#ifdef ARENA_GUARD_PAGES
+    void* map;
+    size_t map_size;
+#endif
 } MemoryArena;
 
 typedef size_t ArenaMarker;
 
-static inline void arena_init(MemoryArena* arena, size_t cap)
+// Every arena is registered under a name and subsystem so its usage shows up in the memory report.
+// A budget of 0 means the arena is tracked but never warned about.
+static inline void arena_init(MemoryArena* arena, size_t cap, const char* name, MemSubsystem subsys, size_t budget)
 {
+#ifdef ARENA_GUARD_PAGES
+    // Rounding the capacity keeps a flush base 64-byte aligned; the rounding is usable arena space
+    cap = (cap + 63) & ~(size_t)63;
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t body = (cap + page - 1) & ~(page - 1);
+
+    arena->base = NULL;
+    arena->map_size = body + page;
+    arena->map = mmap(NULL, arena->map_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (arena->map == MAP_FAILED) {
+        arena->map = NULL;
+    } else if (mprotect((unsigned char*)arena->map + body, page, PROT_NONE) != 0) {
+        munmap(arena->map, arena->map_size);
+        arena->map = NULL;
+    } else {
+        // Push the arena up against the guard page so arena->base + cap is its first byte
+        arena->base = (unsigned char*)arena->map + (body - cap);
+    }
+#else
     arena->base = (unsigned char*)util_malloc(cap, __FILE__, __LINE__);
+#endif
     if (!arena->base) {
         util_err("Failed to malloc arena");
+        cap = 0;
     }
     arena->cap = cap;
     arena->offset = 0;
+    arena->reg = memreg_register(name, subsys, budget, cap);
+
+    if (arena->base) {
+        ARENA_POISON(arena->base, cap);
+    }
 }
 
 static inline size_t align_forward(size_t ptr, size_t align)
@@ -34,12 +105,14 @@ static inline size_t align_forward(size_t ptr, size_t align)
 
 static inline void* arena_alloc_aligned(MemoryArena* arena, size_t size, size_t align)
 {
-    size_t aligned_offset = align_forward(arena->offset, align);
+    size_t aligned_offset = align_forward(arena->offset + ARENA_REDZONE, align);
     if (aligned_offset + size > arena->cap) {
         util_error("No space left in arena: size=%zu, cap=%zu, offset=%zu", size, arena->cap, aligned_offset);
         return NULL;
     }
     void* ptr = arena->base + aligned_offset;
+    ARENA_UNPOISON(ptr, size);
+    memreg_track(arena->reg, arena->offset, aligned_offset + size);
     arena->offset = aligned_offset + size;
     return ptr;
 }
@@ -51,19 +124,44 @@ static inline ArenaMarker arena_get_marker(MemoryArena* arena)
 
 static inline void arena_set_marker(MemoryArena* arena, ArenaMarker marker)
 {
+    if (marker < arena->offset) {
+        ARENA_POISON(arena->base + marker, arena->offset - marker);
+    }
+    memreg_track(arena->reg, arena->offset, marker);
     arena->offset = marker;
 }
 
 static inline void arena_reset(MemoryArena* arena)
 {
+    if (arena->offset) {
+        ARENA_POISON(arena->base, arena->offset);
+    }
+    memreg_track(arena->reg, arena->offset, 0);
     arena->offset = 0;
 }
 
 static inline void arena_free(MemoryArena* arena)
 {
+    memreg_track(arena->reg, arena->offset, 0);
+    memreg_release(arena->reg, arena->cap);
+#ifdef ARENA_GUARD_PAGES
+    if (arena->map) {
+        // Pages can be handed back by a later mmap, so ASan mustn't still think they're poisoned
+        ARENA_UNPOISON(arena->base, arena->cap);
+        munmap(arena->map, arena->map_size);
+        arena->map = NULL;
+    }
+#else
+    if (arena->base) {
+        // The allocator may hand this block out again, so it must not stay poisoned
+        ARENA_UNPOISON(arena->base, arena->cap);
+    }
     util_free(arena->base, __FILE__, __LINE__);
+#endif
+    arena->base = NULL;
     arena->cap = 0;
     arena->offset = 0;
+    arena->reg = MEMREG_NONE;
 }
 
 #endif // !ARENA_H_
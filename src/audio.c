@@ -0,0 +1,251 @@
+#include "audio.h"
+#include "utils.h"
+#include <SDL3/SDL_audio.h>
+#include <SDL3/SDL_timer.h>
+#include <stdio.h>
+#include <string.h>
+
+static void audio_prepare(Audio* audio, u32 buffer_frames);
+static bool audio_open(Audio* audio);
+static void audio_callback(void* userdata, SDL_AudioStream* stream, int additional_amount, int total_amount);
+static bool audio_push(Audio* audio, const AudioCmd* cmd);
+static void audio_drain_cmds(Audio* audio);
+static void audio_render(Audio* audio, f32* out, u32 frames);
+
+static f32 wavetables[AUDIO_WAVE_COUNT][AUDIO_WAVE_SIZE];
+
+// Classic Simon pitches, one per quadrant
+static const f32 quad_freqs[AUDIO_WAVE_COUNT] = {209.0f, 252.0f, 310.0f, 415.0f};
+
+bool audio_init(Audio* audio, u32 buffer_frames)
+{
+    audio_prepare(audio, buffer_frames);
+    if (!audio_open(audio)) {
+        return false;
+    }
+
+    audio->ready = true;
+
+    return true;
+}
+
+void audio_play_quad(Audio* audio, const u8 quad, const f32 secs)
+{
+    if (!audio->ready || quad >= AUDIO_WAVE_COUNT) {
+        return;
+    }
+
+    AudioCmd cmd = {
+        .type = AUDIO_CMD_NOTE_ON,
+        .wave = quad,
+        .phase_inc = (u32)(quad_freqs[quad] / AUDIO_SAMPLE_RATE * 4294967296.0),
+        .gate_frames = (u32)(secs * AUDIO_SAMPLE_RATE),
+        .trigger_ns = SDL_GetTicksNS(),
+    };
+    audio_push(audio, &cmd);
+}
+
+void audio_stop_all(Audio* audio)
+{
+    if (!audio->ready) {
+        return;
+    }
+
+    AudioCmd cmd = {.type = AUDIO_CMD_ALL_OFF, .trigger_ns = SDL_GetTicksNS()};
+    audio_push(audio, &cmd);
+}
+
+void audio_destroy(Audio* audio)
+{
+    if (!audio->stream) {
+        return;
+    }
+
+    audio->ready = false;
+    SDL_DestroyAudioStream(audio->stream);
+    audio->stream = NULL;
+    SDL_QuitSubSystem(SDL_INIT_AUDIO);
+
+    if (audio->latency_samples) {
+        util_info("audio: trigger-to-callback avg=%.3fms max=%.3fms over %llu triggers, %llu dropped",
+                  (f64)audio->latency_ns_total / audio->latency_samples / 1e6,
+                  (f64)audio->latency_ns_max / 1e6,
+                  (unsigned long long)audio->latency_samples,
+                  (unsigned long long)audio->cmds_dropped);
+    }
+}
+
+// ------------------------------------------------------------------------------------------------
+
+static void audio_prepare(Audio* audio, u32 buffer_frames)
+{
+    memset(audio, 0, sizeof(*audio));
+
+    if (buffer_frames == 0) buffer_frames = AUDIO_DEFAULT_FRAMES;
+    audio->buffer_frames = buffer_frames;
+
+    audio->attack_inc = 1.0f / (AUDIO_ATTACK_SECS * AUDIO_SAMPLE_RATE);
+    audio->release_mul = expf(logf(1e-3f) / (AUDIO_RELEASE_SECS * AUDIO_SAMPLE_RATE));
+
+    SDL_SetAtomicInt(&audio->cmd_head, 0);
+    SDL_SetAtomicInt(&audio->cmd_tail, 0);
+    SDL_SetAtomicInt(&audio->last_latency_us, 0);
+
+    // Must be set before the device opens; small buffers keep trigger-to-speaker latency down
+    char frames[16];
+    snprintf(frames, sizeof(frames), "%u", buffer_frames);
+    SDL_SetHint(SDL_HINT_AUDIO_DEVICE_SAMPLE_FRAMES, frames);
+}
+
+static bool audio_open(Audio* audio)
+{
+    // Each quadrant gets its own timbre: a sine with progressively more odd harmonics
+    for (u32 w = 0; w < AUDIO_WAVE_COUNT; ++w) {
+        for (u32 i = 0; i < AUDIO_WAVE_SIZE; ++i) {
+            f32 x = 2.0f * M_PI * (f32)i / AUDIO_WAVE_SIZE;
+            f32 s = sinf(x);
+            f32 norm = 1.0f;
+            for (u32 h = 1; h <= w; ++h) {
+                f32 k = (f32)(2 * h + 1);
+                s += sinf(k * x) / (k * k);
+                norm += 1.0f / (k * k);
+            }
+            wavetables[w][i] = 0.25f * s / norm;
+        }
+    }
+
+    if (!SDL_InitSubSystem(SDL_INIT_AUDIO)) {
+        util_error("Error init'ing SDL audio: %s", SDL_GetError());
+        return false;
+    }
+
+    SDL_AudioSpec spec = {.format = SDL_AUDIO_F32, .channels = 1, .freq = AUDIO_SAMPLE_RATE};
+    audio->stream = SDL_OpenAudioDeviceStream(SDL_AUDIO_DEVICE_DEFAULT_PLAYBACK, &spec, audio_callback, audio);
+    if (!audio->stream) {
+        util_error("Error opening audio stream: %s", SDL_GetError());
+        SDL_QuitSubSystem(SDL_INIT_AUDIO);
+        return false;
+    }
+
+    SDL_ResumeAudioStreamDevice(audio->stream);
+
+    util_info("audio: %s driver, %u frame buffers", SDL_GetCurrentAudioDriver(), audio->buffer_frames);
+
+    return true;
+}
+
+static void audio_callback(void* userdata, SDL_AudioStream* stream, int additional_amount, int total_amount)
+{
+    (void)total_amount;
+
+    Audio* audio = (Audio*)userdata;
+
+    audio_drain_cmds(audio);
+
+    u32 frames = (u32)additional_amount / sizeof(f32);
+    while (frames > 0) {
+        u32 chunk = frames < AUDIO_MIX_FRAMES ? frames : AUDIO_MIX_FRAMES;
+        audio_render(audio, audio->mix, chunk);
+        SDL_PutAudioStreamData(stream, audio->mix, (int)(chunk * sizeof(f32)));
+        frames -= chunk;
+    }
+}
+
+static bool audio_push(Audio* audio, const AudioCmd* cmd)
+{
+    int head = SDL_GetAtomicInt(&audio->cmd_head);
+    int tail = SDL_GetAtomicInt(&audio->cmd_tail);
+
+    if (head - tail >= AUDIO_CMD_QUEUE) {
+        audio->cmds_dropped++;
+        return false;
+    }
+
+    audio->cmds[head % AUDIO_CMD_QUEUE] = *cmd;
+
+    SDL_MemoryBarrierRelease();
+    SDL_SetAtomicInt(&audio->cmd_head, head + 1);
+
+    return true;
+}
+
+static void audio_drain_cmds(Audio* audio)
+{
+    int tail = SDL_GetAtomicInt(&audio->cmd_tail);
+    int head = SDL_GetAtomicInt(&audio->cmd_head);
+    SDL_MemoryBarrierAcquire();
+
+    if (tail == head) {
+        return;
+    }
+
+    u64 now = SDL_GetTicksNS();
+
+    for (; tail != head; ++tail) {
+        const AudioCmd* cmd = &audio->cmds[tail % AUDIO_CMD_QUEUE];
+
+        u64 latency = now - cmd->trigger_ns;
+        audio->latency_ns_total += latency;
+        audio->latency_samples++;
+        if (latency > audio->latency_ns_max) audio->latency_ns_max = latency;
+        SDL_SetAtomicInt(&audio->last_latency_us, (int)(latency / 1000));
+
+        if (cmd->type == AUDIO_CMD_ALL_OFF) {
+            for (u32 v = 0; v < AUDIO_MAX_VOICES; ++v) {
+                audio->voices[v].gate_frames = 0;
+            }
+            continue;
+        }
+
+        // Take a free voice, otherwise steal the oldest
+        AudioVoice* voice = &audio->voices[0];
+        for (u32 v = 0; v < AUDIO_MAX_VOICES; ++v) {
+            if (!audio->voices[v].active) {
+                voice = &audio->voices[v];
+                break;
+            }
+            if (audio->voices[v].age > voice->age) voice = &audio->voices[v];
+        }
+
+        voice->active = true;
+        voice->wave = cmd->wave;
+        voice->phase = 0;
+        voice->phase_inc = cmd->phase_inc;
+        voice->age = 0;
+        voice->gate_frames = cmd->gate_frames;
+        voice->env = 0.0f;
+    }
+
+    SDL_SetAtomicInt(&audio->cmd_tail, tail);
+}
+
+static void audio_render(Audio* audio, f32* out, u32 frames)
+{
+    memset(out, 0, sizeof(f32) * frames);
+
+    for (u32 v = 0; v < AUDIO_MAX_VOICES; ++v) {
+        AudioVoice* voice = &audio->voices[v];
+        if (!voice->active) {
+            continue;
+        }
+
+        const f32* table = wavetables[voice->wave];
+
+        for (u32 i = 0; i < frames; ++i) {
+            // Linear attack, hold while gated, then exponential release
+            if (voice->age < voice->gate_frames) {
+                voice->env = fminf(voice->env + audio->attack_inc, 1.0f);
+            } else {
+                voice->env *= audio->release_mul;
+            }
+
+            out[i] += table[voice->phase >> (32 - AUDIO_WAVE_BITS)] * voice->env;
+            voice->phase += voice->phase_inc;
+            voice->age++;
+        }
+
+        if (voice->age >= voice->gate_frames && voice->env < 1e-3f) {
+            voice->active = false;
+        }
+    }
+}
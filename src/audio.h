@@ -0,0 +1,74 @@
+#ifndef AUDIO_H_
+#define AUDIO_H_
+
+#include "utils.h"
+#include <SDL3/SDL.h>
+
+#define AUDIO_SAMPLE_RATE 48000
+#define AUDIO_DEFAULT_FRAMES 128
+#define AUDIO_WAVE_BITS 11
+#define AUDIO_WAVE_SIZE (1 << AUDIO_WAVE_BITS)
+#define AUDIO_WAVE_COUNT 4
+#define AUDIO_MAX_VOICES 8
+#define AUDIO_CMD_QUEUE 64
+#define AUDIO_MIX_FRAMES 1024
+#define AUDIO_ATTACK_SECS 0.005f
+#define AUDIO_RELEASE_SECS 0.08f
+
+typedef enum {
+    AUDIO_CMD_NOTE_ON,
+    AUDIO_CMD_ALL_OFF,
+} AudioCmdType;
+
+typedef struct {
+    u8 type;
+    u8 wave;
+    u32 phase_inc;
+    u32 gate_frames;
+    u64 trigger_ns;
+} AudioCmd;
+
+typedef struct {
+    bool active;
+    u8 wave;
+    u32 phase;
+    u32 phase_inc;
+    u32 age;
+    u32 gate_frames;
+    f32 env;
+} AudioVoice;
+
+// Tones are triggered from the game thread by pushing onto a lock-free single-producer/
+// single-consumer queue; the audio callback drains it before mixing each buffer, so the only
+// synchronisation between the two threads is the pair of queue indices.
+typedef struct {
+    SDL_AudioStream* stream;
+    u32 buffer_frames;
+
+    // Set once the device is open; until then triggers are ignored
+    bool ready;
+
+    AudioCmd cmds[AUDIO_CMD_QUEUE];
+    SDL_AtomicInt cmd_head;
+    SDL_AtomicInt cmd_tail;
+    u64 cmds_dropped;
+
+    // Owned by the audio thread
+    AudioVoice voices[AUDIO_MAX_VOICES];
+    f32 mix[AUDIO_MIX_FRAMES];
+    f32 attack_inc;
+    f32 release_mul;
+    u64 latency_ns_total;
+    u64 latency_ns_max;
+    u64 latency_samples;
+
+    // Last trigger-to-callback latency in microseconds, for the debug overlay
+    SDL_AtomicInt last_latency_us;
+} Audio;
+
+bool audio_init(Audio* audio, u32 buffer_frames);
+void audio_play_quad(Audio* audio, const u8 quad, const f32 secs);
+void audio_stop_all(Audio* audio);
+void audio_destroy(Audio* audio);
+
+#endif // !AUDIO_H_
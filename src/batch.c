@@ -0,0 +1,210 @@
+#define _DEFAULT_SOURCE
+#include "batch.h"
+#include "rules.h"
+#include "tuning.h"
+#include "utils.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+// Padded so neighbouring workers' counters never share a cache line
+typedef struct {
+    _Alignas(64) const BatchConfig* config;
+    pthread_t thread;
+    u64 rng;
+    u64 games;
+    BatchResult result;
+} BatchWorker;
+
+static void* batch_worker(void* data);
+static void batch_play(BatchWorker* w, Rules* rules);
+static u64 batch_split(u64* state);
+static f32 batch_unit(u64* state);
+static f64 batch_now(void);
+
+bool batch_run(const BatchConfig* config, BatchResult* result)
+{
+    static BatchWorker workers[BATCH_MAX_THREADS];
+
+    u32 n = config->threads;
+    if (n == 0) {
+        long cores = sysconf(_SC_NPROCESSORS_ONLN);
+        n = cores > 0 ? (u32)cores : 1;
+    }
+    if (n > BATCH_MAX_THREADS) n = BATCH_MAX_THREADS;
+    if ((u64)n > config->games) n = config->games ? (u32)config->games : 1;
+
+    memset(result, 0, sizeof(*result));
+    memset(workers, 0, sizeof(workers));
+
+    u64 seed = config->seed;
+    for (u32 i = 0; i < n; ++i) {
+        workers[i].config = config;
+        workers[i].rng = batch_split(&seed);
+        workers[i].games = config->games / n + (i < config->games % n ? 1 : 0);
+    }
+
+    f64 start = batch_now();
+
+    u32 started = 0;
+    for (; started < n; ++started) {
+        if (pthread_create(&workers[started].thread, NULL, batch_worker, &workers[started]) != 0) {
+            util_error("Error starting batch worker %u", started);
+            break;
+        }
+    }
+    for (u32 i = 0; i < started; ++i) {
+        pthread_join(workers[i].thread, NULL);
+    }
+
+    result->secs = batch_now() - start;
+    result->threads = started;
+
+    for (u32 i = 0; i < started; ++i) {
+        const BatchResult* r = &workers[i].result;
+        result->games += r->games;
+        result->wins += r->wins;
+        result->steps += r->steps;
+        result->play_ms += r->play_ms;
+        result->timeouts += r->timeouts;
+        for (u32 l = 0; l <= TUNING_MAX_LEVELS; ++l) {
+            result->lost_at[l] += r->lost_at[l];
+        }
+    }
+
+    return started == n;
+}
+
+void batch_report(const BatchConfig* config, const BatchResult* result)
+{
+    f64 games = result->games ? (f64)result->games : 1.0;
+
+    util_info("batch: %llu games on %u threads in %.3fs: %.0f games/s, %.0f steps/s",
+              (unsigned long long)result->games,
+              result->threads,
+              result->secs,
+              result->games / result->secs,
+              result->steps / result->secs);
+    util_info("batch: accuracy=%.3f reaction=%ums: %.2f%% won, mean game %.1fs, %llu timed out",
+              config->accuracy,
+              config->reaction_ms,
+              100.0 * result->wins / games,
+              result->play_ms / games / SECOND,
+              (unsigned long long)result->timeouts);
+
+    for (u32 l = 1; l <= config->tuning->n_levels; ++l) {
+        if (result->lost_at[l]) {
+            util_info("  lost on level %2u: %6.2f%%", l, 100.0 * result->lost_at[l] / games);
+        }
+    }
+}
+
+// MEMORY_BATCH_THREADS, MEMORY_BATCH_SEED, MEMORY_BOT_ACCURACY, MEMORY_BOT_REACTION_MS and
+// MEMORY_TUNING configure the run
+int batch_main(u64 games)
+{
+    Tuning tuning;
+    const char* tuning_path = getenv("MEMORY_TUNING");
+    tuning_open(&tuning, tuning_path ? tuning_path : TUNING_DEFAULT_PATH);
+
+    const char* threads = getenv("MEMORY_BATCH_THREADS");
+    const char* seed = getenv("MEMORY_BATCH_SEED");
+    const char* accuracy = getenv("MEMORY_BOT_ACCURACY");
+    const char* reaction = getenv("MEMORY_BOT_REACTION_MS");
+
+    BatchConfig config = {
+        .games = games,
+        .threads = threads ? (u32)strtoul(threads, NULL, 10) : 0,
+        .seed = seed ? strtoull(seed, NULL, 10) : (u64)time(NULL),
+        .accuracy = accuracy ? strtof(accuracy, NULL) : BATCH_DEFAULT_ACCURACY,
+        .reaction_ms = reaction ? (u32)strtoul(reaction, NULL, 10) : BATCH_DEFAULT_REACTION_MS,
+        .tuning = tuning.data,
+    };
+
+    BatchResult result;
+    bool ok = batch_run(&config, &result);
+    batch_report(&config, &result);
+
+    tuning_close(&tuning);
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+static void* batch_worker(void* data)
+{
+    BatchWorker* w = (BatchWorker*)data;
+    Rules rules;
+
+    for (u64 g = 0; g < w->games; ++g) {
+        rules_seed(&rules, (u32)(batch_split(&w->rng) >> 32));
+        batch_play(w, &rules);
+    }
+
+    return NULL;
+}
+
+// One game against a simulated player who waits `reaction_ms` before each press and gets it right
+// with probability `accuracy`
+static void batch_play(BatchWorker* w, Rules* rules)
+{
+    const BatchConfig* c = w->config;
+    u64 steps = 0;
+    u64 play_ms = 0;
+
+    rules_new_game(rules);
+
+    while ((rules->phase == RULES_DEAL || rules->phase == RULES_SHOW || rules->phase == RULES_INPUT) &&
+           steps < BATCH_MAX_STEPS) {
+        RulesInput in = {.pressed = RULES_NO_QUAD};
+        u32 dt_ms = rules->timer_ms;
+
+        if (rules->phase == RULES_INPUT) {
+            u8 quad = rules->seq.quads[rules->pos];
+            if (batch_unit(&w->rng) >= c->accuracy) {
+                quad = (quad + 1 + (u8)(batch_split(&w->rng) % (RULES_QUADS - 1))) % RULES_QUADS;
+            }
+            in.pressed = quad;
+            dt_ms = c->reaction_ms;
+        }
+
+        *rules = rules_step(rules, in, dt_ms, c->tuning);
+        play_ms += dt_ms;
+        ++steps;
+    }
+
+    w->result.games++;
+    w->result.steps += steps;
+    w->result.play_ms += play_ms;
+    if (rules->phase == RULES_WON) {
+        w->result.wins++;
+    } else if (rules->phase == RULES_LOST) {
+        w->result.lost_at[rules->level <= TUNING_MAX_LEVELS ? rules->level : TUNING_MAX_LEVELS]++;
+    } else {
+        w->result.timeouts++;
+    }
+}
+
+// splitmix64: used both to derive independent per-thread streams and as the streams themselves
+static u64 batch_split(u64* state)
+{
+    u64 z = (*state += 0x9e3779b97f4a7c15ull);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+}
+
+static f32 batch_unit(u64* state)
+{
+    return (f32)(batch_split(state) >> 40) / (f32)(1 << 24);
+}
+
+static f64 batch_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
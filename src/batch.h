@@ -0,0 +1,42 @@
+#ifndef BATCH_H_
+#define BATCH_H_
+
+#include "rules.h"
+#include "tuning.h"
+#include "utils.h"
+
+#define BATCH_MAX_THREADS 64
+#define BATCH_DEFAULT_ACCURACY 0.98f
+#define BATCH_DEFAULT_REACTION_MS 250
+#define BATCH_MAX_STEPS 1000000 // Per game, in case a tuning table makes one unwinnable and unlosable
+
+// Headless many-game simulation over the rules core, for difficulty tuning and fuzzing. Games are
+// split evenly across worker threads; each thread draws game seeds and player decisions from its
+// own RNG stream derived from `seed`, so a run is reproducible for a given seed and thread count.
+// Games are stepped event to event rather than frame by frame: each step's dt is exactly the time
+// until the next thing can happen, which the rules treat the same as many small steps.
+typedef struct {
+    u64 games;
+    u32 threads; // 0 for one per online core
+    u64 seed;
+    f32 accuracy;    // Chance the simulated player gets each press right
+    u32 reaction_ms; // Delay before each press; only affects game length
+    const TuningData* tuning;
+} BatchConfig;
+
+typedef struct {
+    u64 games;
+    u64 wins;
+    u64 steps;
+    u64 play_ms; // Simulated time across all games
+    u64 timeouts;
+    u64 lost_at[TUNING_MAX_LEVELS + 1]; // Games lost on each level, indexed from 1
+    u32 threads;
+    f64 secs;
+} BatchResult;
+
+bool batch_run(const BatchConfig* config, BatchResult* result);
+void batch_report(const BatchConfig* config, const BatchResult* result);
+int batch_main(u64 games);
+
+#endif // !BATCH_H_
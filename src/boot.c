@@ -0,0 +1,46 @@
+#include "boot.h"
+#include "utils.h"
+#include <SDL3/SDL_timer.h>
+
+static BootPhase phases[BOOT_MAX_PHASES];
+static u32 n_phases = 0;
+static u64 start_ns = 0;
+static u64 last_ns = 0;
+
+void boot_begin(void)
+{
+    // SDL's tick counter starts on first use, so this is safe before SDL_Init
+    start_ns = SDL_GetTicksNS();
+    last_ns = start_ns;
+    n_phases = 0;
+}
+
+void boot_mark(const char* phase)
+{
+    u64 now = SDL_GetTicksNS();
+
+    if (n_phases < BOOT_MAX_PHASES) {
+        phases[n_phases++] = (BootPhase){phase, now - last_ns};
+    }
+
+    last_ns = now;
+}
+
+void boot_report(void)
+{
+    util_info("boot: time to first frame %.1fms", (last_ns - start_ns) / 1e6);
+    for (u32 i = 0; i < n_phases; ++i) {
+        util_info("  %-16s %8.2fms", phases[i].name, phases[i].ns / 1e6);
+    }
+}
+
+void boot_lazy(const char* phase, u64 began_ns)
+{
+    u64 took = SDL_GetTicksNS() - began_ns;
+    util_info("boot: %s ready at %.1fms, took %.2fms", phase, boot_elapsed_ns() / 1e6, took / 1e6);
+}
+
+u64 boot_elapsed_ns(void)
+{
+    return SDL_GetTicksNS() - start_ns;
+}
@@ -0,0 +1,22 @@
+#ifndef BOOT_H_
+#define BOOT_H_
+
+#include "utils.h"
+
+#define BOOT_MAX_PHASES 16
+
+// Startup profile: the main thread marks the end of each phase, and the breakdown up to the first
+// presented frame is logged once that frame is out. Subsystems brought up lazily after that log
+// their own cost and when they became ready with boot_lazy.
+typedef struct {
+    const char* name;
+    u64 ns; // Time spent in this phase
+} BootPhase;
+
+void boot_begin(void);
+void boot_mark(const char* phase);
+void boot_report(void);
+void boot_lazy(const char* phase, u64 began_ns);
+u64 boot_elapsed_ns(void);
+
+#endif // !BOOT_H_
@@ -0,0 +1,133 @@
+#include "bot.h"
+#include "utils.h"
+#include <string.h>
+
+static void bot_push_key(SDL_Scancode key, bool down);
+static u32 bot_rand(Bot* bot);
+
+static const SDL_Scancode quad_keys[QUAD_COUNT] = {
+    [QUAD_DOWN] = SDL_SCANCODE_DOWN,
+    [QUAD_LEFT] = SDL_SCANCODE_LEFT,
+    [QUAD_UP] = SDL_SCANCODE_UP,
+    [QUAD_RIGHT] = SDL_SCANCODE_RIGHT,
+};
+
+void bot_init(Bot* bot, f32 accuracy, u32 reaction_ms, u32 seed)
+{
+    memset(bot, 0, sizeof(*bot));
+
+    bot->active = true;
+    bot->accuracy = clamp_f(accuracy, 0.0f, 1.0f);
+    bot->reaction_ms = reaction_ms;
+    bot->rng = seed | 1u;
+    bot->last_state = STATE_COUNT;
+    bot->held = SDL_SCANCODE_UNKNOWN;
+
+    util_info("bot: accuracy=%.2f reaction=%ums", bot->accuracy, bot->reaction_ms);
+}
+
+void bot_update(Bot* bot, const SimState* sim, u64 now_ms)
+{
+    if (bot->held != SDL_SCANCODE_UNKNOWN) {
+        bot_push_key(bot->held, false);
+        bot->held = SDL_SCANCODE_UNKNOWN;
+    }
+    if (bot->gap_ticks) {
+        --bot->gap_ticks;
+    }
+
+    if (sim->curr_state != bot->last_state) {
+        switch (sim->curr_state) {
+        case STATE_WIN_SCREEN: {
+            ++bot->wins;
+        } break;
+
+        case STATE_GAME_OVER_SCREEN: {
+            ++bot->losses;
+        } break;
+
+        default:
+            break;
+        }
+
+        bot->last_state = sim->curr_state;
+        bot->ready_at_ms = now_ms + bot->reaction_ms;
+    }
+
+    if (now_ms < bot->ready_at_ms || bot->gap_ticks) {
+        return;
+    }
+
+    SDL_Scancode key = SDL_SCANCODE_UNKNOWN;
+
+    switch (sim->curr_state) {
+    case STATE_MAIN_MENU:
+    case STATE_WIN_SCREEN:
+    case STATE_GAME_OVER_SCREEN: {
+        key = SDL_SCANCODE_SPACE;
+        ++bot->games;
+    } break;
+
+    case STATE_IN_GAME_INPUT: {
+        // Once the game is decided the board is held briefly before the result screen; nothing to press
+        const Rules* rules = &sim->rules;
+        if (rules->phase != RULES_INPUT || rules->pos >= rules->seq.n_quads) {
+            break;
+        }
+
+        u8 quad = rules->seq.quads[rules->pos];
+        if ((f32)(bot_rand(bot) & 0xffffff) / (f32)0x1000000 >= bot->accuracy) {
+            quad = (quad + 1 + bot_rand(bot) % (QUAD_COUNT - 1)) % QUAD_COUNT;
+            ++bot->misses;
+        }
+        key = quad_keys[quad];
+        ++bot->presses;
+    } break;
+
+    default:
+        break;
+    }
+
+    if (key == SDL_SCANCODE_UNKNOWN) {
+        return;
+    }
+
+    bot_push_key(key, true);
+    bot->held = key;
+    bot->gap_ticks = BOT_MIN_GAP_TICKS;
+    bot->ready_at_ms = now_ms + bot->reaction_ms;
+}
+
+void bot_report(const Bot* bot)
+{
+    util_info("bot: %llu games, %llu wins, %llu losses, %llu presses (%llu deliberate misses)",
+              (unsigned long long)bot->games,
+              (unsigned long long)bot->wins,
+              (unsigned long long)bot->losses,
+              (unsigned long long)bot->presses,
+              (unsigned long long)bot->misses);
+}
+
+// ------------------------------------------------------------------------------------------------
+
+static void bot_push_key(SDL_Scancode key, bool down)
+{
+    SDL_Event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.type = down ? SDL_EVENT_KEY_DOWN : SDL_EVENT_KEY_UP;
+    ev.key.scancode = key;
+    ev.key.down = down;
+
+    if (!SDL_PushEvent(&ev)) {
+        util_warn("bot: dropped synthetic key event: %s", SDL_GetError());
+    }
+}
+
+static u32 bot_rand(Bot* bot)
+{
+    u32 x = bot->rng;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return bot->rng = x;
+}
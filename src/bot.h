@@ -0,0 +1,37 @@
+#ifndef BOT_H_
+#define BOT_H_
+
+#include "game.h"
+#include "utils.h"
+#include <SDL3/SDL.h>
+
+#define BOT_DEFAULT_ACCURACY 0.95f
+#define BOT_DEFAULT_REACTION_MS 250
+#define BOT_MIN_GAP_TICKS 2 // Down one tick, up the next, so every press is a fresh edge
+
+// Autoplayer: reads the sequence straight out of the sim and drives the game through the same path
+// a player does, by pushing synthetic key events onto SDL's queue ahead of the tick's event drain.
+// A key is pressed on one tick and released on the next so the input layer sees a clean edge.
+typedef struct {
+    bool active;
+    f32 accuracy;
+    u32 reaction_ms;
+    u32 rng;
+
+    State last_state;
+    u64 ready_at_ms;
+    u32 gap_ticks;
+    SDL_Scancode held;
+
+    u64 games;
+    u64 wins;
+    u64 losses;
+    u64 presses;
+    u64 misses;
+} Bot;
+
+void bot_init(Bot* bot, f32 accuracy, u32 reaction_ms, u32 seed);
+void bot_update(Bot* bot, const SimState* sim, u64 now_ms);
+void bot_report(const Bot* bot);
+
+#endif // !BOT_H_
@@ -0,0 +1,243 @@
+#include "capture.h"
+#include "arena.h"
+#include "utils.h"
+#include <SDL3/SDL_render.h>
+#include <SDL3/SDL_timer.h>
+#include <SDL3_image/SDL_image.h>
+#include <stdio.h>
+#include <string.h>
+
+static int capture_worker(void* data);
+static bool capture_encode(Capture* cap, CaptureSlot* slot);
+
+bool capture_init(Capture* cap, SDL_Renderer* renderer, CaptureFormat format, const char* dir)
+{
+    memset(cap, 0, sizeof(*cap));
+    cap->format = format;
+    snprintf(cap->dir, sizeof(cap->dir), "%s", dir);
+
+    int w, h;
+    if (!SDL_GetRenderOutputSize(renderer, &w, &h)) {
+        util_error("Error getting render output size: %s", SDL_GetError());
+        return false;
+    }
+
+    if (!SDL_CreateDirectory(cap->dir)) {
+        util_error("Error creating capture dir '%s': %s", cap->dir, SDL_GetError());
+        return false;
+    }
+
+    // Slots are sized for the output at startup; larger frames after a resize are counted and
+    // dropped rather than reallocating on the render thread
+    cap->slot_size = (size_t)w * (size_t)h * SDL_BYTESPERPIXEL(CAPTURE_PIXEL_FORMAT);
+    arena_init(&cap->mem,
+               (cap->slot_size + 64) * CAPTURE_RING_SIZE + ARENA_SLACK(CAPTURE_RING_SIZE),
+               "capture.ring",
+               MEM_SUBSYS_CAPTURE,
+               0);
+    if (!cap->mem.base) {
+        return false;
+    }
+    for (size_t i = 0; i < CAPTURE_RING_SIZE; ++i) {
+        cap->slots[i].pixels = (u8*)arena_alloc_aligned(&cap->mem, cap->slot_size, 64);
+    }
+
+    if (format == CAPTURE_RAW) {
+        char path[FPATH_MAX];
+        snprintf(path, sizeof(path), "%s/capture.raw", cap->dir);
+        cap->raw_out = fopen(path, "wb");
+        if (!cap->raw_out) {
+            util_error("Error opening '%s'", path);
+            arena_free(&cap->mem);
+            return false;
+        }
+    }
+
+    SDL_SetAtomicInt(&cap->head, 0);
+    SDL_SetAtomicInt(&cap->tail, 0);
+    SDL_SetAtomicInt(&cap->quit, 0);
+
+    cap->ready = SDL_CreateSemaphore(0);
+    cap->worker = SDL_CreateThread(capture_worker, "capture", cap);
+    if (!cap->ready || !cap->worker) {
+        util_error("Error starting capture worker: %s", SDL_GetError());
+        if (cap->raw_out) fclose(cap->raw_out);
+        if (cap->ready) SDL_DestroySemaphore(cap->ready);
+        arena_free(&cap->mem);
+        return false;
+    }
+
+    util_info("capture: %s, %dx%d into %s", format == CAPTURE_PNG ? "png" : "raw", w, h, cap->dir);
+
+    return true;
+}
+
+void capture_frame(Capture* cap, SDL_Renderer* renderer)
+{
+    u64 frame = cap->frames_seen++;
+
+    int head = SDL_GetAtomicInt(&cap->head);
+    int tail = SDL_GetAtomicInt(&cap->tail);
+    if (head - tail >= CAPTURE_RING_SIZE) {
+        // Back-pressure: the worker is behind, so skip the readback entirely
+        cap->frames_dropped_full++;
+        return;
+    }
+
+    u64 start = SDL_GetTicksNS();
+
+    // SDL3 has no readback into a caller-owned buffer, so this allocates a surface every frame;
+    // it is freed as soon as the pixels are in the slot
+    SDL_Surface* surface = SDL_RenderReadPixels(renderer, NULL);
+    if (!surface) {
+        util_error("Error reading pixels: %s", SDL_GetError());
+        cap->frames_dropped_readback++;
+        return;
+    }
+
+    size_t row_bytes = (size_t)surface->w * SDL_BYTESPERPIXEL(CAPTURE_PIXEL_FORMAT);
+    if (row_bytes * (size_t)surface->h > cap->slot_size) {
+        cap->frames_dropped_size++;
+        SDL_DestroySurface(surface);
+        return;
+    }
+
+    CaptureSlot* slot = &cap->slots[head % CAPTURE_RING_SIZE];
+    slot->format = CAPTURE_PIXEL_FORMAT;
+    slot->w = surface->w;
+    slot->h = surface->h;
+    slot->pitch = (int)row_bytes;
+    slot->frame = frame;
+
+    bool ok = true;
+    if (surface->format == CAPTURE_PIXEL_FORMAT) {
+        const u8* src = (const u8*)surface->pixels;
+        for (int y = 0; y < surface->h; ++y) {
+            memcpy(slot->pixels + (size_t)y * row_bytes, src + (size_t)y * surface->pitch, row_bytes);
+        }
+    } else {
+        ok = SDL_ConvertPixels(surface->w,
+                               surface->h,
+                               surface->format,
+                               surface->pixels,
+                               surface->pitch,
+                               CAPTURE_PIXEL_FORMAT,
+                               slot->pixels,
+                               slot->pitch);
+    }
+    SDL_DestroySurface(surface);
+    if (!ok) {
+        util_error("Error converting captured frame: %s", SDL_GetError());
+        cap->frames_dropped_readback++;
+        return;
+    }
+
+    cap->readback_ns += SDL_GetTicksNS() - start;
+    cap->frames_queued++;
+
+    // Publish the slot contents before the worker can observe the new head
+    SDL_MemoryBarrierRelease();
+    SDL_SetAtomicInt(&cap->head, head + 1);
+    SDL_SignalSemaphore(cap->ready);
+}
+
+void capture_destroy(Capture* cap)
+{
+    if (!cap->worker) {
+        return;
+    }
+
+    SDL_SetAtomicInt(&cap->quit, 1);
+    SDL_SignalSemaphore(cap->ready);
+    SDL_WaitThread(cap->worker, NULL);
+    SDL_DestroySemaphore(cap->ready);
+
+    if (cap->raw_out) {
+        fclose(cap->raw_out);
+        util_info("capture: raw frames are %dx%d, pixel format 0x%x",
+                  cap->slots[0].w,
+                  cap->slots[0].h,
+                  (unsigned)cap->slots[0].format);
+    }
+
+    util_info("capture: seen=%llu queued=%llu encoded=%llu failed=%llu dropped_full=%llu dropped_size=%llu "
+              "dropped_readback=%llu",
+              (unsigned long long)cap->frames_seen,
+              (unsigned long long)cap->frames_queued,
+              (unsigned long long)cap->frames_encoded,
+              (unsigned long long)cap->frames_failed,
+              (unsigned long long)cap->frames_dropped_full,
+              (unsigned long long)cap->frames_dropped_size,
+              (unsigned long long)cap->frames_dropped_readback);
+    if (cap->frames_queued) {
+        util_info("capture: readback avg=%.3fms", (f64)cap->readback_ns / cap->frames_queued / 1e6);
+    }
+    if (cap->frames_encoded) {
+        util_info("capture: encode avg=%.3fms", (f64)cap->encode_ns / cap->frames_encoded / 1e6);
+    }
+
+    arena_free(&cap->mem);
+    cap->worker = NULL;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+static int capture_worker(void* data)
+{
+    Capture* cap = (Capture*)data;
+
+    for (;;) {
+        SDL_WaitSemaphore(cap->ready);
+
+        int tail = SDL_GetAtomicInt(&cap->tail);
+        int head = SDL_GetAtomicInt(&cap->head);
+        SDL_MemoryBarrierAcquire();
+
+        // Drain everything queued so far; the quit flag is only honoured once the ring is empty
+        while (tail != head) {
+            u64 start = SDL_GetTicksNS();
+
+            if (capture_encode(cap, &cap->slots[tail % CAPTURE_RING_SIZE])) {
+                cap->frames_encoded++;
+                cap->encode_ns += SDL_GetTicksNS() - start;
+            } else {
+                cap->frames_failed++;
+            }
+
+            SDL_SetAtomicInt(&cap->tail, ++tail);
+            head = SDL_GetAtomicInt(&cap->head);
+            SDL_MemoryBarrierAcquire();
+        }
+
+        if (SDL_GetAtomicInt(&cap->quit)) {
+            break;
+        }
+    }
+
+    return 0;
+}
+
+static bool capture_encode(Capture* cap, CaptureSlot* slot)
+{
+    if (cap->format == CAPTURE_RAW) {
+        size_t size = (size_t)slot->pitch * (size_t)slot->h;
+        return fwrite(slot->pixels, 1, size, cap->raw_out) == size;
+    }
+
+    SDL_Surface* surface = SDL_CreateSurfaceFrom(slot->w, slot->h, slot->format, slot->pixels, slot->pitch);
+    if (!surface) {
+        util_error("Error wrapping capture slot: %s", SDL_GetError());
+        return false;
+    }
+
+    char path[FPATH_MAX];
+    snprintf(path, sizeof(path), "%s/frame_%06llu.png", cap->dir, (unsigned long long)slot->frame);
+
+    bool ok = IMG_SavePNG(surface, path);
+    if (!ok) {
+        util_error("Error saving '%s': %s", path, SDL_GetError());
+    }
+    SDL_DestroySurface(surface);
+
+    return ok;
+}
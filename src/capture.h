@@ -0,0 +1,63 @@
+#ifndef CAPTURE_H_
+#define CAPTURE_H_
+
+#include "arena.h"
+#include <SDL3/SDL.h>
+#include <stdio.h>
+
+#define CAPTURE_RING_SIZE 8
+
+// Slots always hold this format, whatever the renderer reads back in
+#define CAPTURE_PIXEL_FORMAT SDL_PIXELFORMAT_RGBA32
+
+typedef enum {
+    CAPTURE_OFF,
+    CAPTURE_PNG,
+    CAPTURE_RAW,
+} CaptureFormat;
+
+typedef struct {
+    u8* pixels;
+    SDL_PixelFormat format;
+    int w;
+    int h;
+    int pitch;
+    u64 frame;
+} CaptureSlot;
+
+// Frames are read back on the render thread into a ring of preallocated slots and encoded on a
+// worker thread. The ring is single-producer/single-consumer: `head` is only advanced by the
+// render thread and `tail` only by the worker. A full ring drops the frame instead of blocking.
+typedef struct {
+    CaptureFormat format;
+    CaptureSlot slots[CAPTURE_RING_SIZE];
+    size_t slot_size;
+    SDL_AtomicInt head;
+    SDL_AtomicInt tail;
+    SDL_AtomicInt quit;
+    SDL_Semaphore* ready;
+    SDL_Thread* worker;
+    FILE* raw_out;
+    char dir[FPATH_MAX];
+
+    // Render thread counters
+    u64 frames_seen;
+    u64 frames_queued;
+    u64 frames_dropped_full;
+    u64 frames_dropped_size;
+    u64 frames_dropped_readback; // Readback or conversion failed
+    u64 readback_ns;
+
+    // Worker counters, read once the worker has been joined
+    u64 frames_encoded;
+    u64 frames_failed;
+    u64 encode_ns;
+
+    MemoryArena mem;
+} Capture;
+
+bool capture_init(Capture* cap, SDL_Renderer* renderer, CaptureFormat format, const char* dir);
+void capture_frame(Capture* cap, SDL_Renderer* renderer);
+void capture_destroy(Capture* cap);
+
+#endif // !CAPTURE_H_
@@ -0,0 +1,141 @@
+#ifndef CORO_H_
+#define CORO_H_
+
+#include "sched.h"
+#include "utils.h"
+#include <string.h>
+
+// Stackless coroutines in the protothread style: the body is one big switch on the line number of
+// the last suspension point, so a suspended coroutine is just an integer and a couple of flags.
+// Locals do not survive a suspension; anything that must goes in the inline `locals` block. A Coro
+// holds no pointers, so it can be embedded in state that is snapshotted with a plain memcpy. Only
+// one CORO_* suspension macro may appear per line.
+//
+//     static void script(Coro* co)
+//     {
+//         MyLocals* l = (MyLocals*)co->locals;
+//         CORO_BEGIN(co);
+//         CORO_WAIT_MS(co, &sched, 500);
+//         CORO_WAIT_UNTIL(co, some_condition());
+//         CORO_END(co);
+//     }
+
+#define CORO_LOCALS_MAX 32
+
+typedef struct Coro Coro;
+typedef void (*CoroFn)(Coro* co);
+
+struct Coro {
+    u32 line;
+    SchedTimer wake;
+    u64 wake_at;
+    bool sleeping;
+    bool done;
+    _Alignas(16) u8 locals[CORO_LOCALS_MAX];
+};
+
+#define CORO_BEGIN(co)                                                                                             \
+    switch ((co)->line) {                                                                                          \
+    case 0:
+
+#define CORO_END(co)                                                                                               \
+    }                                                                                                              \
+    (co)->done = true;                                                                                             \
+    return
+
+#define CORO_EXIT(co)                                                                                              \
+    do {                                                                                                           \
+        (co)->done = true;                                                                                         \
+        return;                                                                                                    \
+    } while (0)
+
+#define CORO_YIELD(co)                                                                                             \
+    do {                                                                                                           \
+        (co)->line = __LINE__;                                                                                     \
+        return;                                                                                                    \
+    case __LINE__:;                                                                                                \
+    } while (0)
+
+// The condition is re-evaluated on every resume, so keep it to a cheap check
+#define CORO_WAIT_UNTIL(co, cond)                                                                                  \
+    do {                                                                                                           \
+        (co)->line = __LINE__;                                                                                     \
+    case __LINE__:                                                                                                 \
+        if (!(cond)) return;                                                                                       \
+    } while (0)
+
+// Sleeping coroutines are not resumed at all until the scheduler fires their wake timer
+#define CORO_WAIT_MS(co, sched, ms)                                                                                \
+    do {                                                                                                           \
+        coro_sleep((co), (sched), (ms));                                                                           \
+        (co)->line = __LINE__;                                                                                     \
+        return;                                                                                                    \
+    case __LINE__:;                                                                                                \
+    } while (0)
+
+static inline void coro_wake(void* user)
+{
+    Coro* co = (Coro*)user;
+    co->wake = 0;
+    co->sleeping = false;
+}
+
+static inline void coro_sleep(Coro* co, Scheduler* sched, const u64 ms)
+{
+    co->sleeping = true;
+    co->wake_at = sched->now + ms;
+    co->wake = sched_after(sched, ms, coro_wake, co);
+    if (!co->wake) {
+        // Without a timer nothing would ever wake us, so degrade to a plain yield
+        co->sleeping = false;
+    }
+}
+
+static inline void coro_stop(Coro* co, Scheduler* sched)
+{
+    if (co->sleeping) {
+        sched_cancel(sched, co->wake);
+    }
+    co->wake = 0;
+    co->sleeping = false;
+    co->done = true;
+}
+
+static inline bool coro_start(Coro* co, Scheduler* sched, const size_t locals_size)
+{
+    coro_stop(co, sched);
+
+    if (locals_size > CORO_LOCALS_MAX) {
+        util_error("Coroutine locals too large: %zu > %d", locals_size, CORO_LOCALS_MAX);
+        return false;
+    }
+    memset(co->locals, 0, sizeof(co->locals));
+
+    co->line = 0;
+    co->done = false;
+
+    return true;
+}
+
+// After a Coro has been copied back in from a snapshot taken at `snap_now`, re-arm its wake timer
+// against the live scheduler with whatever sleep it had left
+static inline void coro_rearm(Coro* co, Scheduler* sched, const u64 snap_now)
+{
+    if (!co->sleeping) {
+        co->wake = 0;
+        return;
+    }
+
+    u64 remaining = co->wake_at > snap_now ? co->wake_at - snap_now : 0;
+    coro_sleep(co, sched, remaining);
+}
+
+static inline void coro_resume(Coro* co, CoroFn fn)
+{
+    if (co->done || co->sleeping || !fn) {
+        return;
+    }
+    fn(co);
+}
+
+#endif // !CORO_H_
@@ -1,48 +1,130 @@
 #include "game.h"
+#include "audio.h"
+#include "boot.h"
+#include "bot.h"
+#include "capture.h"
 #include "gfx.h"
 #include "input.h"
+#include "memreg.h"
+#include "snapshot.h"
+#include "soak.h"
+#include "stress.h"
 #include "utils.h"
 #include <SDL3/SDL_pixels.h>
 #include <SDL3/SDL_render.h>
 #include <SDL3/SDL_timer.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <time.h>
 
+// in_game_script's state across suspensions; the script sits in the sim, so this is snapshotted with it
+typedef struct {
+    u8 pressed;
+} InGameLocals;
+
 static void process_events(void);
-static void load_level(const u8 level);
 static void update(const f64 dt);
+static bool update_history(void);
+static void restore_sim(const SimState* snap);
+static bool sim_validate(const SimState* sim);
+static const char* savestate_path(void);
 static void render(void);
+static void render_mem_report(void);
 static void update_main_menu(void);
 static void update_game_over_screen(void);
 static void update_win_screen(void);
-static void update_in_game(void);
+static void start_game(void);
+static void in_game_script(Coro* co);
+static void present_in_game(void);
+static u8 pressed_quad(void);
+static void poll_tuning(void* user);
+static void init_gamepad(void* user);
+static void init_audio(void* user);
+static void light_quad(const u8 quad);
 static void render_main_menu(void);
 static void render_game_over_screen(void);
 static void render_win_screen(void);
 static void render_in_game(void);
+static void update_stress(void);
+static void render_stress(void);
+
+_Static_assert(QUAD_COUNT == RULES_QUADS, "quadrant enum must match the rules core");
 
 static GameState state;
 static StateFns states;
+static StressScene stress;
+static Capture capture;
+static Audio audio;
+static Bot bot;
+static Soak soak;
 
 bool game_init(void)
 {
-    if (!SDL_Init(SDL_INIT_VIDEO)) {
+    boot_begin();
+
+    memreg_set_subsys_budget(MEM_SUBSYS_GFX, MEM_BUDGET_GFX);
+    memreg_set_subsys_budget(MEM_SUBSYS_INPUT, MEM_BUDGET_INPUT);
+    memreg_set_subsys_budget(MEM_SUBSYS_GAME, MEM_BUDGET_GAME);
+    memreg_set_subsys_budget(MEM_SUBSYS_LOG, MEM_BUDGET_LOG);
+    memreg_set_subsys_budget(MEM_SUBSYS_AUDIO, MEM_BUDGET_AUDIO);
+    memreg_set_subsys_budget(MEM_SUBSYS_CAPTURE, MEM_BUDGET_CAPTURE);
+
+    // MEMORY_SOAK=<frames> plays that many frames with the autoplayer, headless and uncapped on a
+    // fixed-step virtual clock, then reports any resource growth
+    const char* soak_frames = getenv("MEMORY_SOAK");
+    if (soak_frames) {
+        soak_init(&soak, strtoull(soak_frames, NULL, 10));
+    }
+
+    // MEMORY_HEADLESS runs without a display, e.g. to benchmark capture or the stress scene in CI
+    if (getenv("MEMORY_HEADLESS") || soak_frames) {
+        SDL_SetHint(SDL_HINT_VIDEO_DRIVER, "offscreen");
+        SDL_SetHint(SDL_HINT_RENDER_DRIVER, "software");
+        SDL_SetHint(SDL_HINT_AUDIO_DRIVER, "dummy");
+    }
+
+    // Only what the first frame needs is brought up before it. The gamepad and audio subsystems
+    // follow on the main thread from scheduler callbacks once the menu is already up;
+    // MEMORY_EAGER_INIT does it all up front instead, to compare the two
+    bool eager = getenv("MEMORY_EAGER_INIT") != NULL;
+
+    if (!SDL_Init(SDL_INIT_VIDEO | (eager ? SDL_INIT_GAMEPAD : 0))) {
         util_error("Error init'ing SDL: %s", SDL_GetError());
         return false;
     }
+    boot_mark("sdl_init");
 
     state.window = SDL_CreateWindow("DEV SDL3", WINDOW_WIDTH, WINDOW_HEIGHT, SDL_WINDOW_RESIZABLE);
     if (!state.window) {
         util_error("Error creating SDL window: %s", SDL_GetError());
         return false;
     }
+    boot_mark("window");
 
     state.renderer = SDL_CreateRenderer(state.window, NULL);
     if (!state.renderer) {
         util_error("Error creating SDL renderer: %s", SDL_GetError());
         return false;
     }
+    boot_mark("renderer");
+
+    // MEMORY_CAPTURE=png|raw records every presented frame into MEMORY_CAPTURE_DIR
+    const char* capture_fmt = getenv("MEMORY_CAPTURE");
+    if (capture_fmt) {
+        CaptureFormat fmt = strcmp(capture_fmt, "raw") == 0 ? CAPTURE_RAW : CAPTURE_PNG;
+        const char* capture_dir = getenv("MEMORY_CAPTURE_DIR");
+        if (!capture_init(&capture, state.renderer, fmt, capture_dir ? capture_dir : "capture")) {
+            util_error("Error init'ing frame capture");
+            return false;
+        }
+    }
+    boot_mark("capture");
+
+    if (eager) {
+        init_audio(NULL);
+    }
+    boot_mark("audio");
 
     states.update[STATE_MAIN_MENU] = update_main_menu;
     states.render[STATE_MAIN_MENU] = render_main_menu;
@@ -53,46 +135,152 @@ bool game_init(void)
     states.update[STATE_WIN_SCREEN] = update_main_menu;
     states.render[STATE_WIN_SCREEN] = render_win_screen;
 
-    states.update[STATE_IN_GAME] = update_in_game;
     states.render[STATE_IN_GAME] = render_in_game;
-    states.update[STATE_IN_GAME_INPUT] = update_in_game;
+    states.script[STATE_IN_GAME] = in_game_script;
+    states.script_locals[STATE_IN_GAME] = sizeof(InGameLocals);
     states.render[STATE_IN_GAME_INPUT] = render_in_game;
+    states.script[STATE_IN_GAME_INPUT] = in_game_script;
+    states.script_locals[STATE_IN_GAME_INPUT] = sizeof(InGameLocals);
+
+    states.update[STATE_STRESS] = update_stress;
+    states.render[STATE_STRESS] = render_stress;
+
+    boot_mark("states");
+
+    // MEMORY_BOT hands the controls to the autoplayer; MEMORY_BOT_ACCURACY is the chance each press
+    // is right and MEMORY_BOT_REACTION_MS the delay before each one
+    if (getenv("MEMORY_BOT") || soak_frames) {
+        const char* accuracy = getenv("MEMORY_BOT_ACCURACY");
+        const char* reaction = getenv("MEMORY_BOT_REACTION_MS");
+        bot_init(&bot,
+                 accuracy ? strtof(accuracy, NULL) : BOT_DEFAULT_ACCURACY,
+                 reaction ? (u32)strtoul(reaction, NULL, 10) : BOT_DEFAULT_REACTION_MS,
+                 (u32)time(NULL) ^ 0x9e3779b9u);
+    }
+
+    // MEMORY_TUNING overrides where the binary tuning image is mapped from; see tools/tunegen.c
+    const char* tuning_path = getenv("MEMORY_TUNING");
+    tuning_open(&state.tuning, tuning_path ? tuning_path : TUNING_DEFAULT_PATH);
+    boot_mark("tuning");
+
+    // MEMORY_STRESS=<n> swaps the game for the renderer scaling scene, sweeping 1..n boards; each
+    // board plays by the tuning just opened
+    const char* stress_boards = getenv("MEMORY_STRESS");
+    if (stress_boards) {
+        if (!stress_init(&stress, (u32)strtoul(stress_boards, NULL, 10), state.tuning.data)) {
+            util_error("Error init'ing stress scene");
+            return false;
+        }
+        state.sim.curr_state = STATE_STRESS;
+    }
+
+    input_init(&state.input);
+    sched_init(&state.sched, SDL_GetTicks());
+    sched_after(&state.sched, TUNING_POLL_MS, poll_tuning, NULL);
+    anim_init(&state.anim);
 
-    srand((u8)time(NULL));
+    // Rewind is a nicety; without the ring the game just can't go back
+    if (!snapshot_init(&state.rewind, sizeof(SimState), REWIND_SLOTS, "game.rewind", MEM_SUBSYS_GAME)) {
+        util_warn("Continuing without rewind");
+    }
+
+    // Fixed pools live inside static structs; register them so the report covers everything
+    memreg_register_static("log.mlog", MEM_SUBSYS_LOG, sizeof(MemLog) * MAX_MEM_LOGS);
+    memreg_register_static("input.state", MEM_SUBSYS_INPUT, sizeof(Input));
+    memreg_register_static("game.sched", MEM_SUBSYS_GAME, sizeof(Scheduler));
+    memreg_register_static("game.anim", MEM_SUBSYS_GAME, sizeof(AnimSystem));
+    memreg_register_static("game.sim", MEM_SUBSYS_GAME, 2 * sizeof(SimState));
+    memreg_register_static("audio.engine", MEM_SUBSYS_AUDIO, sizeof(Audio));
+    state.pulse_radius = QUAD_RADIUS;
+
+    rules_seed(&state.sim.rules, (u32)time(NULL));
 
     // state.prev_frame_ms = 0.0f;
     state.is_running = true;
+    boot_mark("game_state");
 
     return true;
 }
 
 bool game_run(void)
 {
-    load_level(1);
-    state.curr_state = STATE_MAIN_MENU;
+    if (state.sim.curr_state != STATE_STRESS) {
+        state.sim.curr_state = STATE_MAIN_MENU;
+    }
+
+    bool first_frame = true;
+    if (soak.max_frames) {
+        state.prev_frame_ms = SDL_GetTicks();
+    }
 
     while (state.is_running) {
+        // The stress scene measures raw frame time and the soak plays as fast as it can, so both run
+        // uncapped
         u32 time_to_wait = MILLISECS_PER_FRAME - (SDL_GetTicks() - state.prev_frame_ms);
-        if (time_to_wait > 0 && time_to_wait <= MILLISECS_PER_FRAME) {
+        if (state.sim.curr_state != STATE_STRESS && !soak.max_frames && time_to_wait > 0 &&
+            time_to_wait <= MILLISECS_PER_FRAME) {
             SDL_Delay(time_to_wait);
         }
 
-        f64 dt = (SDL_GetTicks() - state.prev_frame_ms) / 1000.0;
-        state.prev_frame_ms = SDL_GetTicks();
+        u64 frame_start_ns = SDL_GetTicksNS();
+        u64 now = soak.max_frames ? state.prev_frame_ms + MILLISECS_PER_FRAME : SDL_GetTicks();
+        f64 dt = (now - state.prev_frame_ms) / 1000.0;
+        state.prev_frame_ms = now;
 
+        if (bot.active) {
+            bot_update(&bot, &state.sim, state.prev_frame_ms);
+        }
         process_events();
+        sched_advance(&state.sched, state.prev_frame_ms);
         update(dt);
         render();
+
+        if (first_frame) {
+            first_frame = false;
+            boot_mark("first_frame");
+            boot_report();
+            sched_after(&state.sched, 0, init_gamepad, NULL);
+            sched_after(&state.sched, 0, init_audio, NULL);
+        }
+
+        if (soak.max_frames) {
+            soak_frame(&soak, (SDL_GetTicksNS() - frame_start_ns) / 1e6);
+            if (soak.done) {
+                state.is_running = false;
+            }
+        }
     }
 
     return true;
 }
 
-void game_destroy(void)
+bool game_destroy(void)
 {
+    memreg_dump();
+
+    if (bot.active) {
+        bot_report(&bot);
+    }
+    bool clean = true;
+    if (soak.max_frames) {
+        clean = soak_report(&soak);
+    }
+
+    if (stress.max_boards) {
+        stress_destroy(&stress);
+    }
+    gfx_free_scratch();
+    capture_destroy(&capture);
+    audio_destroy(&audio);
+    input_destroy(&state.input);
+    coro_stop(&state.sim.coro, &state.sched);
+    snapshot_destroy(&state.rewind);
+    tuning_close(&state.tuning);
     SDL_DestroyRenderer(state.renderer);
     SDL_DestroyWindow(state.window);
     SDL_Quit();
+
+    return clean;
 }
 
 // ------------------------------------------------------------------------------------------------
@@ -101,47 +289,196 @@ static void process_events(void)
 {
     input_clear(&state.input);
 
-    SDL_Event ev;
+    // Drain the queue a batch at a time so event floods from high-rate devices stay cheap
+    SDL_Event evs[INPUT_EVENT_BATCH];
+    int n;
 
-    while (SDL_PollEvent(&ev)) {
-        if (ev.type == SDL_EVENT_QUIT) {
-            state.is_running = false;
+    SDL_PumpEvents();
+    while ((n = SDL_PeepEvents(evs, INPUT_EVENT_BATCH, SDL_GETEVENT, SDL_EVENT_FIRST, SDL_EVENT_LAST)) > 0) {
+        for (int i = 0; i < n; ++i) {
+            if (evs[i].type == SDL_EVENT_QUIT) {
+                state.is_running = false;
+            }
+
+            input_process(&state.input, &evs[i]);
         }
+    }
+}
 
-        input_process(&state.input, &ev);
+static void update(const f64 dt)
+{
+    state.is_running = !input_is_key_pressed(&state.input, KB_KEY_Q);
+    if (input_is_key_pressed(&state.input, KB_KEY_DEBUG)) {
+        state.show_mem_report = !state.show_mem_report;
+    }
+    state.dt = dt;
+    state.sim.now_ms = state.sched.now;
+
+    anim_update(&state.anim, dt);
+
+    if (update_history()) {
+        return;
+    }
+
+    if (states.update[state.sim.curr_state]) {
+        states.update[state.sim.curr_state]();
+    }
+
+    CoroFn script = states.script[state.sim.curr_state];
+    if (script != state.script) {
+        if (script) {
+            coro_start(&state.sim.coro, &state.sched, states.script_locals[state.sim.curr_state]);
+        } else {
+            // Leaving the board for a result screen or the menu: nothing should keep sounding
+            coro_stop(&state.sim.coro, &state.sched);
+            audio_stop_all(&audio);
+        }
+        state.script = script;
+    }
+    coro_resume(&state.sim.coro, state.script);
+
+    // Snapshots are only taken here, between resumes, where the coroutine sits at a suspension point
+    if (state.script) {
+        snapshot_push(&state.rewind, &state.sim);
     }
 }
 
-static void load_level(const u8 level)
+// Rewind, restart and save-states swap the whole sim block. Returns true when this tick's sim state
+// came from history instead of from advancing the game.
+static bool update_history(void)
 {
-    memset(state.input_quads, false, sizeof(bool) * 4);
+    if (input_is_key_pressed(&state.input, KB_KEY_SAVE)) {
+        if (snapshot_save(savestate_path(), &state.sim, sizeof(SimState), SIM_VERSION)) {
+            util_info("Saved state to %s", savestate_path());
+        }
+    }
 
-    state.curr_level_diff = level;
+    if (input_is_key_pressed(&state.input, KB_KEY_LOAD)) {
+        SimState loaded;
+        if (snapshot_load(savestate_path(), &loaded, sizeof(SimState), SIM_VERSION) && sim_validate(&loaded)) {
+            restore_sim(&loaded);
+            snapshot_clear(&state.rewind);
+            return true;
+        }
+    }
 
-    for (size_t i = 0; i < level * QUAD_COUNT; ++i) {
-        u8 random_quad = rand() % 4;
-        quad_push(&state.quad_stack, i);
+    // Restart replays the current game's opening, sequence included, rather than dealing a new one
+    if (input_is_key_pressed(&state.input, KB_KEY_RESTART) && state.has_restart) {
+        restore_sim(&state.restart);
+        snapshot_clear(&state.rewind);
+        return true;
     }
 
-    // TODO: debug
-    for (size_t i = 0; i < state.quad_stack.n_quads; ++i) {
-        util_info("%d ", state.quad_stack.quads[i]);
+    // One tick back per tick held; once the ring runs dry the game holds at the oldest snapshot
+    if (input_is_key_down(&state.input, KB_KEY_REWIND)) {
+        SimState prev;
+        if (snapshot_pop(&state.rewind, &prev)) {
+            restore_sim(&prev);
+            return true;
+        }
+        return state.script != NULL;
     }
+
+    return false;
 }
 
-static void update(const f64 dt)
+static void restore_sim(const SimState* snap)
 {
-    state.is_running = !input_is_key_pressed(&state.input, KB_KEY_Q);
+    // The live wake timer points at the coroutine about to be overwritten, so drop it first and
+    // re-arm whatever sleep the snapshot had left against the live scheduler
+    coro_stop(&state.sim.coro, &state.sched);
+    state.sim = *snap;
+    coro_rearm(&state.sim.coro, &state.sched, snap->now_ms);
+    state.sim.now_ms = state.sched.now;
+    state.script = states.script[state.sim.curr_state];
+}
+
+// A save-state is raw bytes from disk, and curr_state picks the function pointers called next
+// tick, so everything used as an index is checked before a loaded block replaces the live one
+static bool sim_validate(const SimState* sim)
+{
+    const Rules* rules = &sim->rules;
 
-    if (states.update[state.curr_state]) {
-        states.update[state.curr_state]();
+    if ((u32)sim->curr_state >= STATE_COUNT) {
+        util_error("Bad save-state: state %u", (u32)sim->curr_state);
+        return false;
+    }
+    if (rules->phase > RULES_LOST) {
+        util_error("Bad save-state: rules phase %u", rules->phase);
+        return false;
+    }
+    if (rules->seq.n_quads > RULES_MAX_MOVES || rules->pos > rules->seq.n_quads) {
+        util_error("Bad save-state: sequence %u/%zu", rules->pos, rules->seq.n_quads);
+        return false;
+    }
+    if (rules->lit > RULES_NO_QUAD) {
+        util_error("Bad save-state: lit quad %u", rules->lit);
+        return false;
+    }
+    for (size_t i = 0; i < rules->seq.n_quads; ++i) {
+        if (rules->seq.quads[i] >= RULES_QUADS) {
+            util_error("Bad save-state: quad %u at move %zu", rules->seq.quads[i], i);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static const char* savestate_path(void)
+{
+    // MEMORY_SAVESTATE overrides where F5/F9 write and read the raw save-state
+    const char* path = getenv("MEMORY_SAVESTATE");
+    return path ? path : SAVESTATE_DEFAULT_PATH;
+}
+
+static void render_mem_report(void)
+{
+    f32 y = 40.0f;
+
+    SDL_SetRenderDrawColor(state.renderer, 0x00, 0x00, 0x00, 0xff);
+    SDL_RenderDebugText(state.renderer, 10.0f, y, "memory (KiB)   current      peak    commit    budget");
+    y += 12.0f;
+
+    for (u32 s = 0; s < MEM_SUBSYS_COUNT; ++s) {
+        const MemSubsysStats* st = memreg_subsys(s);
+        if (st->over_budget) {
+            SDL_SetRenderDrawColor(state.renderer, 0xcc, 0x00, 0x00, 0xff);
+        }
+        SDL_RenderDebugTextFormat(state.renderer,
+                                  10.0f,
+                                  y,
+                                  "%-12s %9zu %9zu %9zu %9zu",
+                                  memreg_subsys_name(s),
+                                  st->current / 1024,
+                                  st->peak / 1024,
+                                  st->committed / 1024,
+                                  st->budget / 1024);
+        SDL_SetRenderDrawColor(state.renderer, 0x00, 0x00, 0x00, 0xff);
+        y += 10.0f;
+
+        for (u32 i = 0; i < memreg_count(); ++i) {
+            const MemRegEntry* e = memreg_entry(i);
+            if (e->subsys != s) {
+                continue;
+            }
+            SDL_RenderDebugTextFormat(state.renderer,
+                                      10.0f,
+                                      y,
+                                      "  %-20.20s %9zu %9zu %9zu",
+                                      e->name,
+                                      e->current / 1024,
+                                      e->peak / 1024,
+                                      e->committed / 1024);
+            y += 10.0f;
+        }
     }
 }
 
 static void render_debug_ui(void)
 {
     char curr_state[20];
-    switch (state.curr_state) {
+    switch (state.sim.curr_state) {
     case STATE_MAIN_MENU: {
         snprintf(curr_state, 20, "main_menu");
     } break;
@@ -161,9 +498,35 @@ static void render_debug_ui(void)
     case STATE_IN_GAME_INPUT: {
         snprintf(curr_state, 20, "in_game_input");
     } break;
+
+    case STATE_STRESS: {
+        snprintf(curr_state, 20, "stress");
+    } break;
     };
 
     SDL_RenderDebugText(state.renderer, 10.0f, 10.0f, curr_state);
+
+    if (state.show_mem_report) {
+        render_mem_report();
+    }
+
+    if (audio.ready) {
+        SDL_RenderDebugTextFormat(state.renderer,
+                                  10.0f,
+                                  WINDOW_HEIGHT - 32.0f,
+                                  "audio latency: %.2fms",
+                                  SDL_GetAtomicInt(&audio.last_latency_us) / 1000.0);
+    }
+
+    if (capture.format != CAPTURE_OFF) {
+        SDL_RenderDebugTextFormat(state.renderer,
+                                  10.0f,
+                                  WINDOW_HEIGHT - 20.0f,
+                                  "capture: queued=%llu dropped=%llu",
+                                  (unsigned long long)capture.frames_queued,
+                                  (unsigned long long)(capture.frames_dropped_full + capture.frames_dropped_size +
+                                                       capture.frames_dropped_readback));
+    }
 }
 
 static void render(void)
@@ -171,8 +534,13 @@ static void render(void)
     SDL_SetRenderDrawColor(state.renderer, 0xaa, 0xb0, 0x78, 0xFF);
     SDL_RenderClear(state.renderer);
 
-    if (states.render[state.curr_state]) {
-        states.render[state.curr_state]();
+    if (states.render[state.sim.curr_state]) {
+        states.render[state.sim.curr_state]();
+    }
+
+    // Capture before the overlay so recorded frames only differ where the game itself does
+    if (capture.format != CAPTURE_OFF) {
+        capture_frame(&capture, state.renderer);
     }
 
     render_debug_ui();
@@ -182,95 +550,174 @@ static void render(void)
 
 static void update_main_menu(void)
 {
-    if (input_is_key_pressed(&state.input, KB_KEY_SPACE)) {
-        state.curr_state = STATE_IN_GAME;
+    if (input_is_key_pressed(&state.input, KB_KEY_SPACE) ||
+        input_is_gamepad_btn_pressed(&state.input, GAMEPAD_BTN_START)) {
+        start_game();
     }
     if (input_is_key_pressed(&state.input, KB_KEY_Q)) {
         state.is_running = false;
     }
 }
 
-static void update_in_game(void)
+static void start_game(void)
 {
-    if (state.curr_state != STATE_IN_GAME_INPUT) {
-        timer_start(&state.quad_timer, SDL_GetTicks(), 2.0f * SECOND / state.curr_level_diff);
+    rules_new_game(&state.sim.rules);
+    state.sim.curr_state = STATE_IN_GAME;
 
-        // TODO: debug
-        if (!timer_done(&state.quad_timer, SDL_GetTicks())) {
-            // util_info("quad timer started - %d", state.curr_show_quad);
-        }
+    // Start the script here rather than on the next update so the restart point already holds it
+    state.script = states.script[STATE_IN_GAME];
+    coro_start(&state.sim.coro, &state.sched, states.script_locals[STATE_IN_GAME]);
 
-        if (timer_done(&state.quad_timer, SDL_GetTicks())) {
-            timer_stop(&state.quad_timer);
-            // util_info("quad time done - %d", state.curr_show_quad);
-            // util_info("quad time done - %d", quad_pop(&state.quad_stack));
+    state.restart = state.sim;
+    state.has_restart = true;
+    snapshot_clear(&state.rewind);
+}
 
-            memset(state.input_quads, false, sizeof(bool) * 4);
-            u8 q = state.quad_stack.quads[state.curr_show_quad++];
-            util_info("%d", q);
+// Sequences a game over the rules core: the rules decide what each step means, this only decides
+// when the next one happens. Once a game is decided the board stays up for GAME_END_HOLD_MS, so the
+// deciding press plays out before the result screen.
+static void in_game_script(Coro* co)
+{
+    InGameLocals* l = (InGameLocals*)co->locals;
+    Rules* rules = &state.sim.rules;
 
-            if (state.curr_show_quad > QUAD_COUNT) {
-                state.curr_state = STATE_IN_GAME_INPUT;
-                util_info("next state");
-                return;
-            }
+    CORO_BEGIN(co);
 
-            state.input_quads[q] = true;
+    rules_deal(rules, state.tuning.data);
+    present_in_game();
+
+    while (rules->phase == RULES_SHOW || rules->phase == RULES_INPUT) {
+        if (rules->phase == RULES_SHOW) {
+            CORO_WAIT_MS(co, &state.sched, rules_level(rules, state.tuning.data)->show_interval_ms);
+            rules_show_next(rules, state.tuning.data);
+            present_in_game();
+        } else {
+            CORO_WAIT_UNTIL(co, (l->pressed = pressed_quad()) != QUAD_COUNT);
+            rules_press(rules, l->pressed, state.tuning.data);
+            present_in_game();
+
+            // A press is lit for one frame only
+            CORO_YIELD(co);
+            rules_clear_lit(rules);
         }
+    }
 
-        return;
+    CORO_WAIT_MS(co, &state.sched, GAME_END_HOLD_MS);
+
+    state.sim.curr_state = rules->phase == RULES_WON ? STATE_WIN_SCREEN : STATE_GAME_OVER_SCREEN;
+
+    CORO_END(co);
+}
+
+// Plays what the last rules transition reported and keeps the screen state in step with its phase
+static void present_in_game(void)
+{
+    const Rules* rules = &state.sim.rules;
+
+    if (rules->events & (RULES_EV_LIGHT | RULES_EV_PRESS)) {
+        light_quad(rules->lit);
     }
 
-    memset(state.input_quads, false, sizeof(bool) * 4);
+    switch (rules->phase) {
+    case RULES_SHOW: {
+        state.sim.curr_state = STATE_IN_GAME;
+    } break;
 
-    if (input_is_key_pressed(&state.input, KB_KEY_UP) ||
-        input_is_gamepad_btn_pressed(&state.input, GAMEPAD_BTN_LEFT_UP)) {
-        state.input_quads[QUAD_UP] = true;
+    case RULES_INPUT: {
+        state.sim.curr_state = STATE_IN_GAME_INPUT;
+    } break;
 
-        u8 q = quad_pop(&state.quad_stack);
-        util_info("pressed: %d:%d", QUAD_UP, q);
+    default:
+        // Won and lost stay on the board until in_game_script has held it
+        break;
+    }
+}
 
-        if (q != QUAD_UP) {
-            // state.curr_state = STATE_GAME_OVER_SCREEN;
-            return;
-        }
+static u8 pressed_quad(void)
+{
+    if (input_is_key_pressed(&state.input, KB_KEY_UP) ||
+        input_is_gamepad_btn_pressed(&state.input, GAMEPAD_BTN_LEFT_UP)) {
+        return QUAD_UP;
     }
     if (input_is_key_pressed(&state.input, KB_KEY_RIGHT) ||
         input_is_gamepad_btn_pressed(&state.input, GAMEPAD_BTN_LEFT_RIGHT)) {
-        state.input_quads[QUAD_RIGHT] = true;
-
-        u8 q = quad_pop(&state.quad_stack);
-        util_info("pressed: %d:%d", QUAD_RIGHT, q);
-
-        if (q != QUAD_RIGHT) {
-            // state.curr_state = STATE_GAME_OVER_SCREEN;
-            return;
-        }
+        return QUAD_RIGHT;
     }
     if (input_is_key_pressed(&state.input, KB_KEY_DOWN) ||
         input_is_gamepad_btn_pressed(&state.input, GAMEPAD_BTN_LEFT_DOWN)) {
-        state.input_quads[QUAD_DOWN] = true;
-
-        u8 q = quad_pop(&state.quad_stack);
-        util_info("pressed: %d:%d", QUAD_DOWN, q);
-
-        if (q != QUAD_DOWN) {
-            // state.curr_state = STATE_GAME_OVER_SCREEN;
-            return;
-        }
+        return QUAD_DOWN;
     }
     if (input_is_key_pressed(&state.input, KB_KEY_LEFT) ||
         input_is_gamepad_btn_pressed(&state.input, GAMEPAD_BTN_LEFT_LEFT)) {
-        state.input_quads[QUAD_LEFT] = true;
+        return QUAD_LEFT;
+    }
+    return QUAD_COUNT;
+}
 
-        u8 q = quad_pop(&state.quad_stack);
-        util_info("pressed: %d:%d", QUAD_LEFT, q);
+static void poll_tuning(void* user)
+{
+    (void)user;
 
-        if (q != QUAD_LEFT) {
-            // state.curr_state = STATE_GAME_OVER_SCREEN;
-            return;
-        }
+    tuning_poll(&state.tuning);
+    sched_after(&state.sched, TUNING_POLL_MS, poll_tuning, NULL);
+}
+
+static void init_gamepad(void* user)
+{
+    (void)user;
+
+    if (SDL_WasInit(SDL_INIT_GAMEPAD)) {
+        return;
+    }
+
+    // Devices already plugged in are announced with the usual added events once this returns
+    u64 began = SDL_GetTicksNS();
+    if (!SDL_InitSubSystem(SDL_INIT_GAMEPAD)) {
+        util_warn("Continuing without gamepads: %s", SDL_GetError());
+        return;
+    }
+    boot_lazy("gamepad", began);
+}
+
+// Opening the device can take a few hundred ms on a cold desktop audio server, so it is kept out
+// of the first frame, but SDL subsystems are only brought up on the main thread
+static void init_audio(void* user)
+{
+    (void)user;
+
+    if (audio.ready) {
+        return;
+    }
+
+    // Audio is optional: without a device the game still runs, just silently
+    const char* audio_frames = getenv("MEMORY_AUDIO_FRAMES");
+    u32 frames = audio_frames ? (u32)strtoul(audio_frames, NULL, 10) : AUDIO_DEFAULT_FRAMES;
+    u64 began = SDL_GetTicksNS();
+    if (!audio_init(&audio, frames)) {
+        util_warn("Continuing without audio");
+        return;
     }
+    boot_lazy("audio", began);
+}
+
+static void update_stress(void)
+{
+    stress_update(&stress, state.dt, state.tuning.data);
+    if (stress.done) {
+        state.is_running = false;
+    }
+}
+
+static void light_quad(const u8 quad)
+{
+    const TuningData* t = state.tuning.data;
+
+    audio_play_quad(&audio, quad, t->tone_secs);
+
+    // The pulse expands and fades over a fixed wall-clock duration, independent of frame rate
+    state.pulse_quad = quad;
+    anim_tween(&state.anim, &state.pulse_radius, QUAD_RADIUS, 1.5f * QUAD_RADIUS, t->pulse_secs, EASE_OUT_QUAD);
+    anim_tween(&state.anim, &state.pulse_alpha, 0.5f, 0.0f, t->pulse_secs, EASE_LINEAR);
 }
 
 static void render_main_menu(void)
@@ -291,51 +738,31 @@ static void render_win_screen(void)
     SDL_RenderDebugText(state.renderer, 20.0f, 20.0f, "You win. Press <space> start again, or <escape> to quit");
 }
 
-float radius = QUAD_RADIUS;
-u8 prev_quad = 0;
+static SDL_FColor to_fcolour(const TuningColour c)
+{
+    return (SDL_FColor){c.r, c.g, c.b, c.a};
+}
 
 static void render_in_game(void)
 {
     float cx = 400.0f, cy = 300.0f;
-    u16 segsPerQuarter = 40;
-
-    // colours for 4 slices
-    SDL_FColor colours[4] = {
-        {1.0f, 0.3f, 0.3f, 1.0f}, // red
-        {0.3f, 1.0f, 0.3f, 1.0f}, // green
-        {0.3f, 0.3f, 1.0f, 1.0f}, // blue
-        {1.0f, 1.0f, 0.3f, 1.0f}  // yellow
-    };
-    // SDL_FColor hi_colours[4] = {
-    //     {1.0f, 0.7f, 0.7f, 1.0f}, // soft light red
-    //     {0.7f, 1.0f, 0.7f, 1.0f}, // soft light green
-    //     {0.7f, 0.7f, 1.0f, 1.0f}, // soft light blue
-    //     {1.0f, 1.0f, 0.7f, 1.0f}  // soft light yellow
-    // };
-    SDL_FColor hi_colours[4] = {
-        {1.0f, 0.6f, 0.6f, 1.0f}, // lighter red
-        {0.6f, 1.0f, 0.6f, 1.0f}, // lighter green
-        {0.6f, 0.6f, 1.0f, 1.0f}, // lighter blue
-        {1.0f, 1.0f, 0.6f, 1.0f}  // lighter yellow
-    };
+    u16 segsPerQuarter = GFX_QUARTER_SEGS;
 
-    if (prev_quad == state.curr_show_quad) {
-        if (radius > 1.5f * QUAD_RADIUS) {
-            radius = QUAD_RADIUS;
-            prev_quad++;
-            return;
-        }
-        // if (state.input_quads[state.curr_show_quad]) {
-        f32 start = (float)state.curr_show_quad * (M_PI / 2.0f);
-        f32 end = (float)(state.curr_show_quad + 1) * (M_PI / 2.0f);
+    const TuningColour* colours = state.tuning.data->colours;
+    const TuningColour* hi_colours = state.tuning.data->hi_colours;
+
+    // The pulse only exists while its tween runs; once it finishes the board is drawn plain
+    bool pulsing = anim_is_active(&state.anim, &state.pulse_alpha);
 
-        radius *= 1.1f;
+    if (pulsing) {
+        f32 start = (float)state.pulse_quad * (M_PI / 2.0f);
+        f32 end = (float)(state.pulse_quad + 1) * (M_PI / 2.0f);
 
-        SDL_FColor colour = hi_colours[state.curr_show_quad];
-        colour.a *= 0.5f;
+        SDL_FColor colour = to_fcolour(hi_colours[state.pulse_quad]);
+        colour.a = state.pulse_alpha;
 
         SDL_SetRenderDrawBlendMode(state.renderer, SDL_BLENDMODE_BLEND);
-        render_sector(state.renderer, cx, cy, radius, start, end, segsPerQuarter, colour);
+        render_sector(state.renderer, cx, cy, state.pulse_radius, start, end, segsPerQuarter, colour);
     }
 
     SDL_SetRenderDrawBlendMode(state.renderer, SDL_BLENDMODE_NONE);
@@ -344,26 +771,20 @@ static void render_in_game(void)
         f32 start = (float)q * (M_PI / 2.0f);
         f32 end = (float)(q + 1) * (M_PI / 2.0f);
 
-        if (state.input_quads[q]) {
-            render_sector(state.renderer, cx, cy, QUAD_RADIUS, start, end, segsPerQuarter, hi_colours[q]);
+        if (state.sim.rules.lit == q) {
+            render_sector(state.renderer, cx, cy, QUAD_RADIUS, start, end, segsPerQuarter, to_fcolour(hi_colours[q]));
         } else {
-            render_sector(state.renderer, cx, cy, QUAD_RADIUS, start, end, segsPerQuarter, colours[q]);
+            render_sector(state.renderer, cx, cy, QUAD_RADIUS, start, end, segsPerQuarter, to_fcolour(colours[q]));
         }
     }
 
     SDL_SetRenderDrawColor(state.renderer, 0x66, 0x66, 0x66, 200);
 
-    u16 outlineSegs = 200;
-
-    for (size_t i = 0; i < outlineSegs; ++i) {
-        f32 a1 = (float)i / outlineSegs * 2.0f * M_PI;
-        f32 a2 = (float)(i + 1) / outlineSegs * 2.0f * M_PI;
-
-        i16 x1 = (int)(cx + radius * cosf(a1));
-        i16 y1 = (int)(cy + radius * sinf(a1));
-        i16 x2 = (int)(cx + radius * cosf(a2));
-        i16 y2 = (int)(cy + radius * sinf(a2));
+    f32 radius = pulsing ? state.pulse_radius : QUAD_RADIUS;
+    render_ring(state.renderer, cx, cy, radius, GFX_RING_SEGS);
+}
 
-        SDL_RenderLine(state.renderer, x1, y1, x2, y2);
-    }
+static void render_stress(void)
+{
+    stress_render(&stress, state.renderer, state.tuning.data);
 }
@@ -1,8 +1,14 @@
 #ifndef GAME_H_
 #define GAME_H_
 
+#include "anim.h"
 #include "arena.h"
+#include "coro.h"
 #include "input.h"
+#include "rules.h"
+#include "sched.h"
+#include "snapshot.h"
+#include "tuning.h"
 #include <SDL3/SDL.h>
 
 #define WINDOW_WIDTH 800
@@ -10,8 +16,20 @@
 #define FPS 60
 #define MILLISECS_PER_FRAME 1000 / FPS
 
-#define MAX_MOVES 100
+// Per-subsystem memory caps for the low-RAM cabinet hardware
+#define MEM_BUDGET_GFX (16 * MB)
+#define MEM_BUDGET_INPUT (64 * 1024)
+#define MEM_BUDGET_GAME (1 * MB)
+#define MEM_BUDGET_LOG (8 * MB)
+#define MEM_BUDGET_AUDIO (1 * MB)
+#define MEM_BUDGET_CAPTURE (64 * MB)
+
 #define QUAD_RADIUS 200.0f
+#define TUNING_POLL_MS 250
+#define REWIND_SLOTS (10 * FPS) // Ten seconds of per-tick snapshots
+#define SAVESTATE_DEFAULT_PATH "memory.sav"
+#define SIM_VERSION 3
+#define GAME_END_HOLD_MS 600 // The deciding press plays out on the board before the result screen
 
 typedef void (*StateFn)(void);
 
@@ -29,46 +47,54 @@ typedef enum {
     STATE_GAME_OVER_SCREEN,
     STATE_IN_GAME,
     STATE_IN_GAME_INPUT,
+    STATE_STRESS,
     STATE_COUNT,
 } State;
 
 typedef struct {
     StateFn render[STATE_COUNT];
     StateFn update[STATE_COUNT];
+    // Optional linear script per state. States sharing a script share one running coroutine; it is
+    // restarted whenever the current state's script differs from the one running
+    CoroFn script[STATE_COUNT];
+    size_t script_locals[STATE_COUNT];
 } StateFns;
 
+// Everything the game rules depend on, in one contiguous pointer-free block so a snapshot, rewind
+// step or save-state is a single memcpy. Anything added here must stay pointer-free, and changing
+// the layout must bump SIM_VERSION.
 typedef struct {
-    u8 quads[MAX_MOVES];
-    size_t n_quads;
-} QuadStack;
+    u64 now_ms; // Scheduler time the block was captured at, to re-arm the script's sleep on restore
+    State curr_state;
+    Rules rules;
+    Coro coro;
+} SimState;
 
 typedef struct GameState {
     SDL_Window* window;
     SDL_Renderer* renderer;
 
-    QuadStack quad_stack;
-    bool input_quads[4];
-    Timer quad_timer;
-    u8 curr_level_diff;
-    u8 curr_show_quad;
+    SimState sim;
+    SimState restart; // Captured when a game's opening is laid out
+    bool has_restart;
+    SnapshotRing rewind;
+    CoroFn script; // Script the sim's coroutine is running
+    Scheduler sched;
+    Tuning tuning;
+    AnimSystem anim;
+    f32 pulse_radius;
+    f32 pulse_alpha;
+    u8 pulse_quad;
     Input input;
-    State curr_state;
     u64 prev_frame_ms;
+    f64 dt;
     bool is_running;
+    bool show_mem_report;
 } GameState;
 
 bool game_init(void);
 bool game_run(void);
-void game_destroy(void);
-
-static void quad_push(QuadStack* quad_stack, u8 random_quad)
-{
-    quad_stack->quads[quad_stack->n_quads++] = random_quad;
-}
-
-static u8 quad_pop(QuadStack* quad_stack)
-{
-    return quad_stack->quads[quad_stack->n_quads--];
-}
+// Returns false if a MEMORY_SOAK run found growth, so the process can fail the run
+bool game_destroy(void);
 
 #endif // !GAME_H_
@@ -1,9 +1,50 @@
 #include "gfx.h"
 #include "arena.h"
+#include "trig_tables.h" // Generated by tools/gentrig.c; see the Makefile
 #include "utils.h"
 #include <SDL3/SDL_render.h>
 #include <stddef.h>
 
+_Static_assert(GFX_QUARTER_SEGS * 4 == TRIG_CIRCLE_SEGS, "sector kernel expects a quarter of the circle table");
+_Static_assert(GFX_RING_SEGS == TRIG_RING_SEGS, "ring kernel expects the ring table");
+
+// Fixed-count kernels over the generated unit-circle tables. N is a compile-time constant, so the
+// loops fully unroll and each vertex is a multiply-add of a table entry against scale and offset.
+#define GFX_FAN_KERNEL(out, cx, cy, r, colour, N, COS, SIN)                                                        \
+    do {                                                                                                           \
+        for (int i_ = 0; i_ <= (N); ++i_) {                                                                        \
+            (out)[i_].position.x = (cx) + (r) * (COS)[i_];                                                         \
+            (out)[i_].position.y = (cy) + (r) * (SIN)[i_];                                                         \
+            (out)[i_].color = (colour);                                                                            \
+            (out)[i_].tex_coord.x = 0.0f;                                                                          \
+            (out)[i_].tex_coord.y = 0.0f;                                                                          \
+        }                                                                                                          \
+    } while (0)
+
+#define GFX_RING_KERNEL(out, cx, cy, r, N, COS, SIN)                                                               \
+    do {                                                                                                           \
+        for (int i_ = 0; i_ <= (N); ++i_) {                                                                        \
+            (out)[i_].x = (cx) + (r) * (COS)[i_];                                                                  \
+            (out)[i_].y = (cy) + (r) * (SIN)[i_];                                                                  \
+        }                                                                                                          \
+    } while (0)
+
+static void gfx_sector_verts(SDL_Vertex* verts,
+                             f32 cx,
+                             f32 cy,
+                             f32 r,
+                             f32 start_angle,
+                             f32 end_angle,
+                             u16 segments,
+                             SDL_FColor colour);
+static void gfx_sector_indices(int* indices, int base, u16 segments);
+static i32 gfx_table_quarter(f32 start_angle, f32 end_angle, u16 segments);
+static bool gfx_scratch_reserve(size_t size);
+
+// Scratch for one-off geometry. It is registered on first use, only regrown when a larger shape
+// comes along and reset after every call, so steady-state drawing never touches the allocator.
+static MemoryArena scratch;
+
 void render_sector(SDL_Renderer* renderer,
                    f32 cx,
                    f32 cy,
@@ -13,58 +54,267 @@ void render_sector(SDL_Renderer* renderer,
                    u16 segments,
                    SDL_FColor colour)
 {
-    MemoryArena mem;
+    u32 nindices = (u32)segments * 3;
+    u32 nverts = 1 + (segments + 1);
+
+    if (gfx_table_quarter(start_angle, end_angle, segments) >= 0) {
+        // The fixed-count fan is small and its size known up front, so it lives on the stack
+        SDL_Vertex verts[1 + GFX_QUARTER_SEGS + 1];
+        int indices[GFX_QUARTER_SEGS * 3];
+
+        gfx_sector_verts(verts, cx, cy, r, start_angle, end_angle, segments, colour);
+        gfx_sector_indices(indices, 0, segments);
+        SDL_RenderGeometry(renderer, NULL, verts, (int)nverts, indices, (int)nindices);
+        return;
+    }
 
-    u16 nindices = segments * 3;
-    u16 nverts = 1 + (segments + 1);
     size_t verts_size = sizeof(SDL_Vertex) * nverts;
     size_t indices_size = sizeof(int) * nindices;
 
-    arena_init(&mem, verts_size + indices_size);
+    if (!gfx_scratch_reserve(verts_size + indices_size + 32 + ARENA_SLACK(2))) {
+        return;
+    }
     {
         // Number of vertices: center + (segments+1) arc points
-        SDL_Vertex* verts = (SDL_Vertex*)arena_alloc_aligned(&mem, verts_size, 16);
+        SDL_Vertex* verts = (SDL_Vertex*)arena_alloc_aligned(&scratch, verts_size, 16);
         if (!verts) {
             util_err("no mem for verts");
             return;
         };
 
-        // Center vertex
-        verts[0].position.x = cx;
-        verts[0].position.y = cy;
-        verts[0].color = colour;
-        verts[0].tex_coord.x = 0.0f;
-        verts[0].tex_coord.y = 0.0f;
-
-        // Arc vertices
-        for (int i = 0; i <= segments; ++i) {
-            f32 t = (float)i / (float)segments;
-            f32 angle = start_angle + t * (end_angle - start_angle);
-            f32 x = cx + r * cosf(angle);
-            f32 y = cy + r * sinf(angle);
-
-            verts[1 + i].position.x = x;
-            verts[1 + i].position.y = y;
-            verts[1 + i].color = colour;
-            verts[1 + i].tex_coord.x = 0.0f;
-            verts[1 + i].tex_coord.y = 0.0f;
-        }
+        gfx_sector_verts(verts, cx, cy, r, start_angle, end_angle, segments, colour);
 
         // Build indices for triangles (triangles = segments)
-        int* indices = (int*)arena_alloc_aligned(&mem, indices_size, 16);
+        int* indices = (int*)arena_alloc_aligned(&scratch, indices_size, 16);
         if (!indices) {
             util_err("no mem for indices");
+            arena_reset(&scratch);
             return;
         }
 
-        int idx = 0;
-        for (int i = 0; i < segments; ++i) {
-            indices[idx++] = 0;
-            indices[idx++] = 1 + i;
-            indices[idx++] = 1 + i + 1;
+        gfx_sector_indices(indices, 0, segments);
+
+        SDL_RenderGeometry(renderer, NULL, verts, (int)nverts, indices, (int)nindices);
+    }
+    arena_reset(&scratch);
+}
+
+void render_ring(SDL_Renderer* renderer, f32 cx, f32 cy, f32 r, u16 segments)
+{
+    if (segments == GFX_RING_SEGS) {
+        // 201 points is 1.6KB, comfortably a stack buffer
+        SDL_FPoint points[GFX_RING_SEGS + 1];
+
+        GFX_RING_KERNEL(points, cx, cy, r, GFX_RING_SEGS, TRIG_RING_COS, TRIG_RING_SIN);
+        SDL_RenderLines(renderer, points, GFX_RING_SEGS + 1);
+        return;
+    }
+
+    size_t points_size = sizeof(SDL_FPoint) * (segments + 1);
+
+    if (!gfx_scratch_reserve(points_size + 16 + ARENA_SLACK(1))) {
+        return;
+    }
+    {
+        SDL_FPoint* points = (SDL_FPoint*)arena_alloc_aligned(&scratch, points_size, 16);
+        if (!points) {
+            util_err("no mem for ring points");
+            return;
+        }
+
+        for (int i = 0; i <= segments; ++i) {
+            f32 angle = (float)i / (float)segments * 2.0f * M_PI;
+            points[i].x = cx + r * cosf(angle);
+            points[i].y = cy + r * sinf(angle);
         }
 
-        SDL_RenderGeometry(renderer, NULL, verts, nverts, indices, nindices);
+        SDL_RenderLines(renderer, points, segments + 1);
+    }
+    arena_reset(&scratch);
+}
+
+void gfx_free_scratch(void)
+{
+    if (scratch.base) {
+        arena_free(&scratch);
+    }
+}
+
+// ------------------------------------------------------------------------------------------------
+
+bool gfx_batch_init(GfxBatch* batch, u32 max_verts)
+{
+    // A fan of n segments uses n+2 vertices and 3n indices, so 3x the vertex count is plenty
+    size_t verts_size = sizeof(SDL_Vertex) * max_verts;
+    size_t indices_size = sizeof(int) * max_verts * 3;
+
+    arena_init(&batch->mem, verts_size + indices_size + 32 + ARENA_SLACK(2), "gfx.batch", MEM_SUBSYS_GFX, 0);
+    if (!batch->mem.base) {
+        return false;
+    }
+
+    batch->verts = (SDL_Vertex*)arena_alloc_aligned(&batch->mem, verts_size, 16);
+    batch->indices = (int*)arena_alloc_aligned(&batch->mem, indices_size, 16);
+    if (!batch->verts || !batch->indices) {
+        util_error("no mem for batch buffers");
+        arena_free(&batch->mem);
+        return false;
+    }
+
+    batch->nverts = 0;
+    batch->nindices = 0;
+    batch->max_verts = max_verts;
+    batch->max_indices = max_verts * 3;
+    batch->nflushes = 0;
+
+    return true;
+}
+
+void gfx_batch_sector(GfxBatch* batch,
+                      SDL_Renderer* renderer,
+                      f32 cx,
+                      f32 cy,
+                      f32 r,
+                      f32 start_angle,
+                      f32 end_angle,
+                      u16 segments,
+                      SDL_FColor colour)
+{
+    u32 nverts = 1 + (segments + 1);
+    u32 nindices = segments * 3;
+
+    if (nverts > batch->max_verts || nindices > batch->max_indices) {
+        util_error("sector too large for batch: segments=%u", segments);
+        return;
+    }
+    if (batch->nverts + nverts > batch->max_verts || batch->nindices + nindices > batch->max_indices) {
+        gfx_batch_flush(batch, renderer);
+    }
+
+    SDL_Vertex* verts = batch->verts + batch->nverts;
+    int base = (int)batch->nverts;
+
+    gfx_sector_verts(verts, cx, cy, r, start_angle, end_angle, segments, colour);
+
+    gfx_sector_indices(batch->indices + batch->nindices, base, segments);
+
+    batch->nverts += nverts;
+    batch->nindices += nindices;
+}
+
+void gfx_batch_flush(GfxBatch* batch, SDL_Renderer* renderer)
+{
+    if (batch->nindices == 0) {
+        return;
     }
-    arena_free(&mem);
+
+    SDL_RenderGeometry(renderer, NULL, batch->verts, (int)batch->nverts, batch->indices, (int)batch->nindices);
+
+    batch->nverts = 0;
+    batch->nindices = 0;
+    batch->nflushes++;
+}
+
+void gfx_batch_free(GfxBatch* batch)
+{
+    arena_free(&batch->mem);
+    batch->verts = NULL;
+    batch->indices = NULL;
+    batch->max_verts = 0;
+    batch->max_indices = 0;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+// Writes the centre and the segments+1 arc vertices of a fan. Counts with a generated table take
+// the fixed-count kernel, where each vertex is a table entry scaled and offset with no cosf/sinf;
+// anything else takes the general path.
+static void gfx_sector_verts(SDL_Vertex* verts,
+                             f32 cx,
+                             f32 cy,
+                             f32 r,
+                             f32 start_angle,
+                             f32 end_angle,
+                             u16 segments,
+                             SDL_FColor colour)
+{
+    verts[0].position.x = cx;
+    verts[0].position.y = cy;
+    verts[0].color = colour;
+    verts[0].tex_coord.x = 0.0f;
+    verts[0].tex_coord.y = 0.0f;
+
+    i32 quarter = gfx_table_quarter(start_angle, end_angle, segments);
+    if (quarter >= 0) {
+        const u32 off = (u32)quarter * GFX_QUARTER_SEGS;
+        GFX_FAN_KERNEL(verts + 1,
+                       cx,
+                       cy,
+                       r,
+                       colour,
+                       GFX_QUARTER_SEGS,
+                       TRIG_CIRCLE_COS + off,
+                       TRIG_CIRCLE_SIN + off);
+        return;
+    }
+
+    for (int i = 0; i <= segments; ++i) {
+        f32 t = (float)i / (float)segments;
+        f32 angle = start_angle + t * (end_angle - start_angle);
+
+        verts[1 + i].position.x = cx + r * cosf(angle);
+        verts[1 + i].position.y = cy + r * sinf(angle);
+        verts[1 + i].color = colour;
+        verts[1 + i].tex_coord.x = 0.0f;
+        verts[1 + i].tex_coord.y = 0.0f;
+    }
+}
+
+// Indices for a fan whose centre vertex is at `base`, one triangle per segment
+static void gfx_sector_indices(int* indices, int base, u16 segments)
+{
+    for (int i = 0; i < segments; ++i) {
+        *indices++ = base;
+        *indices++ = base + 1 + i;
+        *indices++ = base + 1 + i + 1;
+    }
+}
+
+// Makes sure the scratch arena can hold `size` bytes. It only ever grows, to the next power of two
+// so a run of slightly larger shapes doesn't regrow it every call.
+static bool gfx_scratch_reserve(size_t size)
+{
+    if (scratch.base && scratch.cap >= size) {
+        return true;
+    }
+
+    size_t cap = 4096;
+    while (cap < size) {
+        cap <<= 1;
+    }
+
+    if (scratch.base) {
+        arena_free(&scratch);
+    }
+    arena_init(&scratch, cap, "gfx.scratch", MEM_SUBSYS_GFX, 0);
+
+    return scratch.base != NULL;
+}
+
+// Which quarter of the circle table a sector covers, or -1 if it isn't a table-aligned quarter
+static i32 gfx_table_quarter(f32 start_angle, f32 end_angle, u16 segments)
+{
+    const f32 quarter_span = TRIG_CIRCLE_SPAN / 4.0f;
+
+    if (segments != GFX_QUARTER_SEGS || fabsf(end_angle - start_angle - quarter_span) > 1e-4f) {
+        return -1;
+    }
+
+    f32 q = start_angle / quarter_span;
+    f32 qr = roundf(q);
+    if (fabsf(q - qr) > 1e-4f) {
+        return -1;
+    }
+
+    return (((i32)qr % 4) + 4) % 4;
 }
@@ -4,6 +4,23 @@
 #include "arena.h"
 #include <SDL3/SDL.h>
 
+// Segment counts with generated-table fast paths: a quarter sector and the full outline ring
+#define GFX_QUARTER_SEGS 40
+#define GFX_RING_SEGS 200
+
+// A batch accumulates sector geometry into persistent vertex/index buffers and submits it with a
+// single SDL_RenderGeometry call, flushing early whenever the buffers fill up.
+typedef struct {
+    MemoryArena mem;
+    SDL_Vertex* verts;
+    int* indices;
+    u32 nverts;
+    u32 nindices;
+    u32 max_verts;
+    u32 max_indices;
+    u32 nflushes;
+} GfxBatch;
+
 void render_sector(SDL_Renderer* renderer,
                    f32 cx,
                    f32 cy,
@@ -12,5 +29,20 @@ void render_sector(SDL_Renderer* renderer,
                    f32 end_angle,
                    u16 segments,
                    SDL_FColor color);
+void render_ring(SDL_Renderer* renderer, f32 cx, f32 cy, f32 r, u16 segments);
+void gfx_free_scratch(void);
+
+bool gfx_batch_init(GfxBatch* batch, u32 max_verts);
+void gfx_batch_sector(GfxBatch* batch,
+                      SDL_Renderer* renderer,
+                      f32 cx,
+                      f32 cy,
+                      f32 r,
+                      f32 start_angle,
+                      f32 end_angle,
+                      u16 segments,
+                      SDL_FColor colour);
+void gfx_batch_flush(GfxBatch* batch, SDL_Renderer* renderer);
+void gfx_batch_free(GfxBatch* batch);
 
 #endif // GFX_H_
@@ -1,20 +1,138 @@
 #include "input.h"
 #include <SDL3/SDL.h>
+#include <string.h>
 
-static void input_process_mouse(Input* input, SDL_Event* ev);
-static void input_process_keyboard(Input* input, SDL_Event* ev);
-static void input_process_gamepad(Input* input, SDL_Event* ev);
+static void input_process_gamepad_axis(Input* input, SDL_GamepadAxisEvent* ev);
+static void input_open_gamepad(Input* input, SDL_JoystickID id);
+static void input_close_gamepad(Input* input, SDL_JoystickID id);
+
+void input_init(Input* input)
+{
+    memset(input, 0, sizeof(*input));
+
+    input_bind_key(input, SDL_SCANCODE_ESCAPE, KB_KEY_Q);
+    input_bind_key(input, SDL_SCANCODE_Q, KB_KEY_Q);
+    input_bind_key(input, SDL_SCANCODE_SPACE, KB_KEY_SPACE);
+    input_bind_key(input, SDL_SCANCODE_F1, KB_KEY_DEBUG);
+    input_bind_key(input, SDL_SCANCODE_BACKSPACE, KB_KEY_REWIND);
+    input_bind_key(input, SDL_SCANCODE_R, KB_KEY_RESTART);
+    input_bind_key(input, SDL_SCANCODE_F5, KB_KEY_SAVE);
+    input_bind_key(input, SDL_SCANCODE_F9, KB_KEY_LOAD);
+    input_bind_key(input, SDL_SCANCODE_UP, KB_KEY_UP);
+    input_bind_key(input, SDL_SCANCODE_DOWN, KB_KEY_DOWN);
+    input_bind_key(input, SDL_SCANCODE_LEFT, KB_KEY_LEFT);
+    input_bind_key(input, SDL_SCANCODE_RIGHT, KB_KEY_RIGHT);
+
+    input_bind_gamepad_btn(input, SDL_GAMEPAD_BUTTON_DPAD_UP, GAMEPAD_BTN_LEFT_UP);
+    input_bind_gamepad_btn(input, SDL_GAMEPAD_BUTTON_DPAD_DOWN, GAMEPAD_BTN_LEFT_DOWN);
+    input_bind_gamepad_btn(input, SDL_GAMEPAD_BUTTON_DPAD_LEFT, GAMEPAD_BTN_LEFT_LEFT);
+    input_bind_gamepad_btn(input, SDL_GAMEPAD_BUTTON_DPAD_RIGHT, GAMEPAD_BTN_LEFT_RIGHT);
+    input_bind_gamepad_btn(input, SDL_GAMEPAD_BUTTON_START, GAMEPAD_BTN_START);
+    input_bind_gamepad_btn(input, SDL_GAMEPAD_BUTTON_SOUTH, GAMEPAD_BTN_START);
+}
+
+void input_bind_key(Input* input, SDL_Scancode key, KeyboardButtons btn)
+{
+    if ((u32)key >= SDL_SCANCODE_COUNT) {
+        return;
+    }
+    input->map.keys[key] |= (1U << btn);
+}
+
+void input_unbind_key(Input* input, SDL_Scancode key)
+{
+    if ((u32)key >= SDL_SCANCODE_COUNT) {
+        return;
+    }
+    input->map.keys[key] = 0;
+}
+
+void input_bind_gamepad_btn(Input* input, SDL_GamepadButton gbtn, GamepadButtons btn)
+{
+    if ((u32)gbtn >= SDL_GAMEPAD_BUTTON_COUNT) {
+        return;
+    }
+    input->map.gamepad_btns[gbtn] |= (1U << btn);
+}
+
+void input_unbind_gamepad_btn(Input* input, SDL_GamepadButton gbtn)
+{
+    if ((u32)gbtn >= SDL_GAMEPAD_BUTTON_COUNT) {
+        return;
+    }
+    input->map.gamepad_btns[gbtn] = 0;
+}
 
 void input_process(Input* input, SDL_Event* ev)
 {
-    input_process_mouse(input, ev);
-    input_process_keyboard(input, ev);
-    input_process_gamepad(input, ev);
+    switch (ev->type) {
+    case SDL_EVENT_KEY_DOWN: {
+        if ((u32)ev->key.scancode < SDL_SCANCODE_COUNT) {
+            input->kb.btns |= input->map.keys[ev->key.scancode];
+        }
+    } break;
+
+    case SDL_EVENT_KEY_UP: {
+        if ((u32)ev->key.scancode < SDL_SCANCODE_COUNT) {
+            input->kb.btns &= ~input->map.keys[ev->key.scancode];
+        }
+    } break;
+
+    case SDL_EVENT_MOUSE_MOTION: {
+        input->mouse.x = ev->motion.x;
+        input->mouse.y = ev->motion.y;
+    } break;
+
+    case SDL_EVENT_MOUSE_BUTTON_DOWN: {
+        // SDL numbers buttons from 1 in the same left/middle/right order as MouseButtons
+        input->mouse.btns |= (1U << (ev->button.button - 1));
+    } break;
+
+    case SDL_EVENT_MOUSE_BUTTON_UP: {
+        input->mouse.btns &= ~(1U << (ev->button.button - 1));
+    } break;
+
+    case SDL_EVENT_GAMEPAD_BUTTON_DOWN: {
+        if (ev->gbutton.which == input->gamepad.id && ev->gbutton.button < SDL_GAMEPAD_BUTTON_COUNT) {
+            input->gamepad.btns_digital |= input->map.gamepad_btns[ev->gbutton.button];
+            input->gamepad.btns = input->gamepad.btns_digital | input->gamepad.btns_axis;
+        }
+    } break;
+
+    case SDL_EVENT_GAMEPAD_BUTTON_UP: {
+        if (ev->gbutton.which == input->gamepad.id && ev->gbutton.button < SDL_GAMEPAD_BUTTON_COUNT) {
+            input->gamepad.btns_digital &= ~input->map.gamepad_btns[ev->gbutton.button];
+            input->gamepad.btns = input->gamepad.btns_digital | input->gamepad.btns_axis;
+        }
+    } break;
+
+    case SDL_EVENT_GAMEPAD_AXIS_MOTION: {
+        if (ev->gaxis.which == input->gamepad.id) {
+            input_process_gamepad_axis(input, &ev->gaxis);
+        }
+    } break;
+
+    case SDL_EVENT_GAMEPAD_ADDED: {
+        input_open_gamepad(input, ev->gdevice.which);
+    } break;
+
+    case SDL_EVENT_GAMEPAD_REMOVED: {
+        input_close_gamepad(input, ev->gdevice.which);
+    } break;
+    }
 }
 
 void input_clear(Input* input)
 {
     input->kb.btns_prev = input->kb.btns;
+    input->gamepad.btns_prev = input->gamepad.btns;
+}
+
+void input_destroy(Input* input)
+{
+    if (input->gamepad.handle) {
+        input_close_gamepad(input, input->gamepad.id);
+    }
 }
 
 bool input_is_key_pressed(Input* input, KeyboardButtons btn)
@@ -34,78 +152,78 @@ bool input_is_mouse_btn_pressed(Input* input, MouseButtons btn)
 
 bool input_is_gamepad_btn_pressed(Input* input, GamepadButtons btn)
 {
-    return IS_SET(input->gamepad.btns, btn);
+    return IS_SET(input->gamepad.btns, btn) && !IS_SET(input->gamepad.btns_prev, btn);
 }
 
-// ------------------------------------------------------------------------------------------------
-
-static void input_process_mouse(Input* input, SDL_Event* ev)
+bool input_is_gamepad_btn_down(Input* input, GamepadButtons btn)
 {
-    input->mouse.x = ev->motion.x;
-    input->mouse.y = ev->motion.y;
+    return IS_SET(input->gamepad.btns, btn);
 }
 
-static void input_process_keyboard(Input* input, SDL_Event* ev)
-{
-    if (ev->type == SDL_EVENT_KEY_DOWN) {
-        switch (ev->key.key) {
-        case SDLK_ESCAPE:
-        case SDLK_Q: {
-            input->kb.btns |= (1U << KB_KEY_Q);
-        } break;
-
-        case SDLK_SPACE: {
-            input->kb.btns |= (1U << KB_KEY_SPACE);
-        } break;
-
-        case SDLK_UP: {
-            input->kb.btns |= (1U << KB_KEY_UP);
-        } break;
-
-        case SDLK_LEFT: {
-            input->kb.btns |= (1U << KB_KEY_LEFT);
-        } break;
-
-        case SDLK_DOWN: {
-            input->kb.btns |= (1U << KB_KEY_DOWN);
-        } break;
+// ------------------------------------------------------------------------------------------------
 
-        case SDLK_RIGHT: {
-            input->kb.btns |= (1U << KB_KEY_RIGHT);
-        } break;
-        }
+static void input_process_gamepad_axis(Input* input, SDL_GamepadAxisEvent* ev)
+{
+    GamepadButtons neg, pos;
+
+    switch (ev->axis) {
+    case SDL_GAMEPAD_AXIS_LEFTX: {
+        neg = GAMEPAD_BTN_LEFT_LEFT;
+        pos = GAMEPAD_BTN_LEFT_RIGHT;
+    } break;
+
+    case SDL_GAMEPAD_AXIS_LEFTY: {
+        // SDL's Y axis points down
+        neg = GAMEPAD_BTN_LEFT_UP;
+        pos = GAMEPAD_BTN_LEFT_DOWN;
+    } break;
+
+    default:
+        return;
     }
 
-    if (ev->type == SDL_EVENT_KEY_UP) {
-        switch (ev->key.key) {
-        case SDLK_ESCAPE:
-        case SDLK_Q: {
-            input->kb.btns &= ~(1U << KB_KEY_Q);
-        } break;
+    // Separate press/release thresholds stop a stick resting near the edge from chattering
+    u32 btns = input->gamepad.btns_axis;
+    i32 v = ev->value;
 
-        case SDLK_SPACE: {
-            input->kb.btns &= ~(1U << KB_KEY_SPACE);
-        } break;
+    if (v <= -INPUT_AXIS_PRESS) btns |= (1U << neg);
+    if (v > -INPUT_AXIS_RELEASE) btns &= ~(1U << neg);
+    if (v >= INPUT_AXIS_PRESS) btns |= (1U << pos);
+    if (v < INPUT_AXIS_RELEASE) btns &= ~(1U << pos);
 
-        case SDLK_UP: {
-            input->kb.btns &= ~(1U << KB_KEY_UP);
-        } break;
-
-        case SDLK_LEFT: {
-            input->kb.btns &= ~(1U << KB_KEY_LEFT);
-        } break;
+    input->gamepad.btns_axis = btns;
+    input->gamepad.btns = input->gamepad.btns_digital | btns;
+}
 
-        case SDLK_DOWN: {
-            input->kb.btns &= ~(1U << KB_KEY_DOWN);
-        } break;
+static void input_open_gamepad(Input* input, SDL_JoystickID id)
+{
+    // Only the first connected pad drives the game
+    if (input->gamepad.handle) {
+        return;
+    }
 
-        case SDLK_RIGHT: {
-            input->kb.btns &= ~(1U << KB_KEY_RIGHT);
-        } break;
-        }
+    input->gamepad.handle = SDL_OpenGamepad(id);
+    if (!input->gamepad.handle) {
+        util_error("Error opening gamepad %u: %s", id, SDL_GetError());
+        return;
     }
+    input->gamepad.id = id;
+
+    util_info("gamepad %u connected", id);
 }
 
-static void input_process_gamepad(Input* input, SDL_Event* ev)
+static void input_close_gamepad(Input* input, SDL_JoystickID id)
 {
+    if (!input->gamepad.handle || input->gamepad.id != id) {
+        return;
+    }
+
+    SDL_CloseGamepad(input->gamepad.handle);
+    input->gamepad.handle = NULL;
+    input->gamepad.id = 0;
+    input->gamepad.btns_digital = 0;
+    input->gamepad.btns_axis = 0;
+    input->gamepad.btns = 0;
+
+    util_info("gamepad %u disconnected", id);
 }
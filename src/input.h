@@ -4,6 +4,10 @@
 #include "utils.h"
 #include <SDL3/SDL.h>
 
+#define INPUT_EVENT_BATCH 64
+#define INPUT_AXIS_PRESS (SDL_JOYSTICK_AXIS_MAX / 2)
+#define INPUT_AXIS_RELEASE (SDL_JOYSTICK_AXIS_MAX / 3)
+
 typedef enum {
     MOUSE_BTN_LEFT,
     MOUSE_BTN_MIDDLE,
@@ -17,6 +21,11 @@ typedef enum {
     KB_KEY_LEFT,
     KB_KEY_RIGHT,
     KB_KEY_SPACE,
+    KB_KEY_DEBUG,
+    KB_KEY_REWIND,
+    KB_KEY_RESTART,
+    KB_KEY_SAVE,
+    KB_KEY_LOAD,
     KB_KEY_COUNT,
 } KeyboardButtons;
 
@@ -25,6 +34,8 @@ typedef enum {
     GAMEPAD_BTN_LEFT_DOWN,
     GAMEPAD_BTN_LEFT_LEFT,
     GAMEPAD_BTN_LEFT_RIGHT,
+    GAMEPAD_BTN_START,
+    GAMEPAD_BTN_COUNT,
 } GamepadButtons;
 
 typedef struct {
@@ -33,7 +44,14 @@ typedef struct {
 } Keyboard;
 
 typedef struct {
+    SDL_Gamepad* handle;
+    SDL_JoystickID id;
+    // Digital buttons and the left stick are tracked separately so releasing one can't clear a
+    // direction still held on the other
+    u32 btns_digital;
+    u32 btns_axis;
     u32 btns;
+    u32 btns_prev;
 } Gamepad;
 
 typedef struct {
@@ -42,19 +60,34 @@ typedef struct {
     u32 btns;
 } Mouse;
 
+// Bindings are dense tables indexed by scancode and gamepad button holding the action bits to
+// set, so handling a press is one lookup and one OR regardless of how many actions are bound.
+typedef struct {
+    u32 keys[SDL_SCANCODE_COUNT];
+    u32 gamepad_btns[SDL_GAMEPAD_BUTTON_COUNT];
+} InputMap;
+
 typedef struct {
     Mouse mouse;
     Keyboard kb;
     Gamepad gamepad;
+    InputMap map;
 } Input;
 
 #define IS_SET(mask, bit) ((mask) & (1U << (bit)))
 
+void input_init(Input* input);
+void input_bind_key(Input* input, SDL_Scancode key, KeyboardButtons btn);
+void input_unbind_key(Input* input, SDL_Scancode key);
+void input_bind_gamepad_btn(Input* input, SDL_GamepadButton gbtn, GamepadButtons btn);
+void input_unbind_gamepad_btn(Input* input, SDL_GamepadButton gbtn);
 void input_process(Input* input, SDL_Event* ev);
 void input_clear(Input* input);
+void input_destroy(Input* input);
 bool input_is_key_pressed(Input* input, KeyboardButtons btn);
 bool input_is_key_down(Input* input, KeyboardButtons btn);
 bool input_is_mouse_btn_pressed(Input* input, MouseButtons btn);
 bool input_is_gamepad_btn_pressed(Input* input, GamepadButtons btn);
+bool input_is_gamepad_btn_down(Input* input, GamepadButtons btn);
 
 #endif // !INPUT_H_
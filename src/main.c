@@ -1,8 +1,16 @@
+#include "batch.h"
 #include "game.h"
 #include "utils.h"
+#include <stdlib.h>
 
 int main(void)
 {
+    // MEMORY_BATCH=<games> simulates that many games headless across all cores instead of playing
+    const char* batch_games = getenv("MEMORY_BATCH");
+    if (batch_games) {
+        return batch_main(strtoull(batch_games, NULL, 10));
+    }
+
     if (!game_init()) {
         util_error("Failed to start game");
         return EXIT_FAILURE;
@@ -13,7 +21,10 @@ int main(void)
         return EXIT_FAILURE;
     }
 
-    game_destroy();
+    if (!game_destroy()) {
+        util_error("Soak run found growth");
+        return EXIT_FAILURE;
+    }
 
     return EXIT_SUCCESS;
 }
@@ -0,0 +1,201 @@
+#include "memreg.h"
+#include "utils.h"
+#include <stdio.h>
+#include <string.h>
+
+static void memreg_check_budget(MemRegEntry* e);
+static void memreg_check_subsys_budget(MemSubsystem subsys);
+
+static MemRegEntry entries[MEMREG_MAX_ENTRIES];
+static u32 n_entries = 0;
+static MemSubsysStats subsystems[MEM_SUBSYS_COUNT];
+
+static const char* subsys_names[MEM_SUBSYS_COUNT] = {
+    "gfx",
+    "input",
+    "game",
+    "log",
+    "audio",
+    "capture",
+};
+
+i32 memreg_register(const char* name, MemSubsystem subsys, size_t budget, size_t committed)
+{
+    i32 id = MEMREG_NONE;
+
+    for (u32 i = 0; i < n_entries; ++i) {
+        if (entries[i].subsys == subsys && strncmp(entries[i].name, name, MEMREG_NAME_MAX - 1) == 0) {
+            id = (i32)i;
+            break;
+        }
+    }
+
+    if (id == MEMREG_NONE) {
+        if (n_entries >= MEMREG_MAX_ENTRIES) {
+            util_warn("memreg full – not tracking '%s'", name);
+            return MEMREG_NONE;
+        }
+
+        id = (i32)n_entries++;
+        MemRegEntry* e = &entries[id];
+        memset(e, 0, sizeof(*e));
+        snprintf(e->name, sizeof(e->name), "%s", name);
+        e->subsys = subsys;
+    }
+
+    MemRegEntry* e = &entries[id];
+    e->budget = budget;
+    e->committed += committed;
+    e->live++;
+
+    subsystems[subsys].committed += committed;
+    memreg_check_budget(e);
+    memreg_check_subsys_budget(subsys);
+
+    return id;
+}
+
+void memreg_register_static(const char* name, MemSubsystem subsys, size_t bytes)
+{
+    i32 id = memreg_register(name, subsys, bytes, bytes);
+    memreg_track(id, 0, bytes);
+}
+
+void memreg_release(i32 id, size_t committed)
+{
+    if (id == MEMREG_NONE) {
+        return;
+    }
+
+    MemRegEntry* e = &entries[id];
+    MemSubsysStats* s = &subsystems[e->subsys];
+
+    e->committed -= committed;
+    e->live--;
+    s->committed -= committed;
+
+    if (e->committed <= e->budget && e->current <= e->budget) e->over_budget = false;
+    if (s->committed <= s->budget && s->current <= s->budget) s->over_budget = false;
+}
+
+void memreg_track(i32 id, size_t old_used, size_t new_used)
+{
+    if (id == MEMREG_NONE || old_used == new_used) {
+        return;
+    }
+
+    MemRegEntry* e = &entries[id];
+    MemSubsysStats* s = &subsystems[e->subsys];
+
+    e->current = e->current - old_used + new_used;
+    s->current = s->current - old_used + new_used;
+
+    if (new_used < old_used) {
+        // Shrinking can only bring us back under budget; re-arm the warning for the next breach
+        if (e->budget && e->current <= e->budget) e->over_budget = false;
+        if (s->budget && s->current <= s->budget) s->over_budget = false;
+        return;
+    }
+
+    if (e->current > e->peak) e->peak = e->current;
+    if (s->current > s->peak) s->peak = s->current;
+
+    memreg_check_budget(e);
+    memreg_check_subsys_budget(e->subsys);
+}
+
+void memreg_set_subsys_budget(MemSubsystem subsys, size_t budget)
+{
+    subsystems[subsys].budget = budget;
+    memreg_check_subsys_budget(subsys);
+}
+
+const char* memreg_subsys_name(MemSubsystem subsys)
+{
+    return subsys_names[subsys];
+}
+
+u32 memreg_count(void)
+{
+    return n_entries;
+}
+
+const MemRegEntry* memreg_entry(u32 i)
+{
+    return &entries[i];
+}
+
+const MemSubsysStats* memreg_subsys(MemSubsystem subsys)
+{
+    return &subsystems[subsys];
+}
+
+void memreg_dump(void)
+{
+    util_info("memory usage (bytes):");
+    util_info("  %-8s %-24s %12s %12s %12s %12s", "subsys", "name", "current", "peak", "committed", "budget");
+
+    for (u32 s = 0; s < MEM_SUBSYS_COUNT; ++s) {
+        for (u32 i = 0; i < n_entries; ++i) {
+            const MemRegEntry* e = &entries[i];
+            if (e->subsys != s) {
+                continue;
+            }
+            util_info("  %-8s %-24s %12zu %12zu %12zu %12zu%s",
+                      subsys_names[s],
+                      e->name,
+                      e->current,
+                      e->peak,
+                      e->committed,
+                      e->budget,
+                      e->budget && e->peak > e->budget ? "  OVER" : "");
+        }
+
+        const MemSubsysStats* st = &subsystems[s];
+        util_info("  %-8s %-24s %12zu %12zu %12zu %12zu%s",
+                  subsys_names[s],
+                  "(total)",
+                  st->current,
+                  st->peak,
+                  st->committed,
+                  st->budget,
+                  st->budget && st->peak > st->budget ? "  OVER" : "");
+    }
+}
+
+// ------------------------------------------------------------------------------------------------
+
+static void memreg_check_budget(MemRegEntry* e)
+{
+    if (!e->budget || e->over_budget) {
+        return;
+    }
+
+    if (e->current > e->budget || e->committed > e->budget) {
+        e->over_budget = true;
+        util_warn("%s/%s over budget: current=%zu committed=%zu budget=%zu",
+                  subsys_names[e->subsys],
+                  e->name,
+                  e->current,
+                  e->committed,
+                  e->budget);
+    }
+}
+
+static void memreg_check_subsys_budget(MemSubsystem subsys)
+{
+    MemSubsysStats* s = &subsystems[subsys];
+
+    if (!s->budget || s->over_budget) {
+        return;
+    }
+
+    if (s->current > s->budget || s->committed > s->budget) {
+        s->over_budget = true;
+        util_warn("%s over budget: current=%zu committed=%zu budget=%zu",
+                  subsys_names[subsys],
+                  s->current,
+                  s->committed,
+                  s->budget);
+    }
+}
@@ -0,0 +1,52 @@
+#ifndef MEMREG_H_
+#define MEMREG_H_
+
+#include "utils.h"
+
+#define MEMREG_MAX_ENTRIES 64
+#define MEMREG_NAME_MAX 32
+#define MEMREG_NONE -1
+
+typedef enum {
+    MEM_SUBSYS_GFX,
+    MEM_SUBSYS_INPUT,
+    MEM_SUBSYS_GAME,
+    MEM_SUBSYS_LOG,
+    MEM_SUBSYS_AUDIO,
+    MEM_SUBSYS_CAPTURE,
+    MEM_SUBSYS_COUNT,
+} MemSubsystem;
+
+// One entry per named arena or pool. Arenas that are created and freed repeatedly under the same
+// name (e.g. per-call scratch) share an entry, so their peak survives across uses.
+typedef struct {
+    char name[MEMREG_NAME_MAX];
+    MemSubsystem subsys;
+    size_t budget;
+    size_t current;
+    size_t peak;
+    size_t committed;
+    u32 live;
+    bool over_budget;
+} MemRegEntry;
+
+typedef struct {
+    size_t budget;
+    size_t current;
+    size_t peak;
+    size_t committed;
+    bool over_budget;
+} MemSubsysStats;
+
+i32 memreg_register(const char* name, MemSubsystem subsys, size_t budget, size_t committed);
+void memreg_register_static(const char* name, MemSubsystem subsys, size_t bytes);
+void memreg_release(i32 id, size_t committed);
+void memreg_track(i32 id, size_t old_used, size_t new_used);
+void memreg_set_subsys_budget(MemSubsystem subsys, size_t budget);
+const char* memreg_subsys_name(MemSubsystem subsys);
+u32 memreg_count(void);
+const MemRegEntry* memreg_entry(u32 i);
+const MemSubsysStats* memreg_subsys(MemSubsystem subsys);
+void memreg_dump(void);
+
+#endif // !MEMREG_H_
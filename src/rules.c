@@ -0,0 +1,167 @@
+#include "rules.h"
+#include "tuning.h"
+#include "utils.h"
+#include <string.h>
+
+static void rules_deal_level(Rules* rules, u8 level, const TuningData* tuning);
+static u32 rules_rand(Rules* rules);
+
+void rules_seed(Rules* rules, u32 seed)
+{
+    memset(rules, 0, sizeof(*rules));
+
+    // xorshift never leaves zero, so force a bit on
+    rules->rng = seed | 1u;
+    rules->phase = RULES_IDLE;
+    rules->lit = RULES_NO_QUAD;
+}
+
+// Carries the RNG on from the previous game, so consecutive games deal different sequences. The
+// deal itself happens in the next step, so its RULES_EV_LEVEL reaches whoever reads that step.
+void rules_new_game(Rules* rules)
+{
+    rules->phase = RULES_DEAL;
+    rules->level = 0;
+    rules->pos = 0;
+    rules->lit = RULES_NO_QUAD;
+    rules->timer_ms = 0;
+    rules->events = 0;
+    rules->seq.n_quads = 0;
+}
+
+Rules rules_step(const Rules* rules, RulesInput input, u32 dt_ms, const TuningData* tuning)
+{
+    Rules next = *rules;
+    next.events = 0;
+
+    switch (next.phase) {
+    case RULES_DEAL: {
+        rules_deal(&next, tuning);
+    } break;
+
+    case RULES_SHOW: {
+        // A level starts dark: the previous level's last press is cleared on the first show step
+        if (next.pos == 0) {
+            rules_clear_lit(&next);
+        }
+
+        next.timer_ms = next.timer_ms > dt_ms ? next.timer_ms - dt_ms : 0;
+        if (next.timer_ms == 0) {
+            rules_show_next(&next, tuning);
+        }
+    } break;
+
+    case RULES_INPUT: {
+        // A press is lit for the step it happens in only
+        rules_clear_lit(&next);
+        if (input.pressed < RULES_QUADS) {
+            rules_press(&next, input.pressed, tuning);
+        }
+    } break;
+
+    default:
+        break;
+    }
+
+    return next;
+}
+
+void rules_deal(Rules* rules, const TuningData* tuning)
+{
+    rules->events = 0;
+    if (rules->phase != RULES_DEAL) {
+        return;
+    }
+
+    rules_deal_level(rules, 1, tuning);
+}
+
+// Lights the next quad of the sequence, or hands over to the player once it has all been shown
+void rules_show_next(Rules* rules, const TuningData* tuning)
+{
+    rules->events = 0;
+    if (rules->phase != RULES_SHOW) {
+        return;
+    }
+
+    if (rules->pos < rules->seq.n_quads) {
+        rules->lit = rules->seq.quads[rules->pos++];
+        rules->timer_ms = rules_level(rules, tuning)->show_interval_ms;
+        rules->events |= RULES_EV_LIGHT;
+    } else {
+        rules->lit = RULES_NO_QUAD;
+        rules->pos = 0;
+        rules->phase = RULES_INPUT;
+        rules->events |= RULES_EV_INPUT;
+    }
+}
+
+// Checks one press against the sequence; finishing a level deals the next, or wins after the last
+void rules_press(Rules* rules, u8 quad, const TuningData* tuning)
+{
+    rules->events = 0;
+    if (rules->phase != RULES_INPUT || quad >= RULES_QUADS) {
+        return;
+    }
+
+    rules->lit = quad;
+    rules->events |= RULES_EV_PRESS;
+
+    if (quad != rules->seq.quads[rules->pos]) {
+        rules->phase = RULES_LOST;
+        rules->events |= RULES_EV_LOST;
+        return;
+    }
+
+    if (++rules->pos < rules->seq.n_quads) {
+        return;
+    }
+
+    if (rules->level >= tuning->n_levels) {
+        rules->phase = RULES_WON;
+        rules->events |= RULES_EV_WON;
+    } else {
+        rules_deal_level(rules, rules->level + 1, tuning);
+    }
+}
+
+void rules_clear_lit(Rules* rules)
+{
+    rules->lit = RULES_NO_QUAD;
+}
+
+const TuningLevel* rules_level(const Rules* rules, const TuningData* tuning)
+{
+    // A hot reload can shrink the table under a game in progress, so clamp rather than trust it
+    u32 n = tuning->n_levels;
+    u32 i = rules->level ? rules->level - 1u : 0u;
+    return &tuning->levels[i < n ? i : n - 1];
+}
+
+// ------------------------------------------------------------------------------------------------
+
+static void rules_deal_level(Rules* rules, u8 level, const TuningData* tuning)
+{
+    rules->level = level;
+    rules->phase = RULES_SHOW;
+    rules->pos = 0;
+    rules->seq.n_quads = 0;
+
+    const TuningLevel* l = rules_level(rules, tuning);
+    u32 moves = l->moves < RULES_MAX_MOVES ? l->moves : RULES_MAX_MOVES;
+    for (u32 i = 0; i < moves; ++i) {
+        quad_push(&rules->seq, (u8)(rules_rand(rules) % RULES_QUADS));
+    }
+
+    rules->timer_ms = l->show_interval_ms;
+    rules->events |= RULES_EV_LEVEL;
+}
+
+static u32 rules_rand(Rules* rules)
+{
+    u32 x = rules->rng;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return rules->rng = x;
+}
@@ -0,0 +1,70 @@
+#ifndef RULES_H_
+#define RULES_H_
+
+#include "tuning.h"
+#include "utils.h"
+
+#define RULES_MAX_MOVES TUNING_MAX_MOVES
+#define RULES_QUADS 4
+#define RULES_NO_QUAD RULES_QUADS
+
+typedef enum {
+    RULES_IDLE,  // No game started yet
+    RULES_DEAL,  // A game was started; the next step deals its first level
+    RULES_SHOW,  // Playing the sequence back
+    RULES_INPUT, // Waiting for the player to repeat it
+    RULES_WON,
+    RULES_LOST,
+} RulesPhase;
+
+// What happened during the last step, for whatever presents the game
+typedef enum {
+    RULES_EV_LIGHT = 1 << 0, // `lit` was shown as part of the sequence
+    RULES_EV_INPUT = 1 << 1, // Playback finished, the player's turn starts
+    RULES_EV_PRESS = 1 << 2, // The player pressed `lit`
+    RULES_EV_LEVEL = 1 << 3, // A new level's sequence was dealt
+    RULES_EV_WON = 1 << 4,
+    RULES_EV_LOST = 1 << 5,
+} RulesEvent;
+
+typedef struct {
+    u8 quads[RULES_MAX_MOVES];
+    size_t n_quads;
+} QuadStack;
+
+// The complete state of one game: fixed size, pointer-free and owning its own RNG, so any number
+// can be stepped independently, copied or written to disk as-is
+typedef struct {
+    u32 rng;
+    u8 phase;
+    u8 level;
+    u8 pos;  // Next sequence index to show or to verify
+    u8 lit;  // Quad currently lit, RULES_NO_QUAD if none
+    u32 timer_ms; // Until the next quad is shown
+    u32 events;
+    QuadStack seq;
+} Rules;
+
+typedef struct {
+    u8 pressed; // RULES_NO_QUAD if nothing was pressed this step
+} RulesInput;
+
+void rules_seed(Rules* rules, u32 seed);
+void rules_new_game(Rules* rules);
+Rules rules_step(const Rules* rules, RulesInput input, u32 dt_ms, const TuningData* tuning);
+
+// The single transitions rules_step is built from, for callers that sequence a game themselves
+// rather than drive it from a clock. Each replaces `events` with what it raised and does nothing
+// outside its phase.
+void rules_deal(Rules* rules, const TuningData* tuning);
+void rules_show_next(Rules* rules, const TuningData* tuning);
+void rules_press(Rules* rules, u8 quad, const TuningData* tuning);
+void rules_clear_lit(Rules* rules);
+const TuningLevel* rules_level(const Rules* rules, const TuningData* tuning);
+
+static inline void quad_push(QuadStack* quad_stack, u8 random_quad)
+{
+    quad_stack->quads[quad_stack->n_quads++] = random_quad;
+}
+
+#endif // !RULES_H_
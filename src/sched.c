@@ -0,0 +1,196 @@
+#include "sched.h"
+#include "utils.h"
+#include <string.h>
+
+static void sched_link(Scheduler* sched, u16 idx);
+static void sched_unlink(Scheduler* sched, u16 idx);
+static void sched_release(Scheduler* sched, u16 idx);
+static void sched_cascade(Scheduler* sched, u8 level);
+static SchedNode* sched_lookup(Scheduler* sched, SchedTimer timer);
+
+void sched_init(Scheduler* sched, const u64 now_ms)
+{
+    memset(sched->slots, 0xff, sizeof(sched->slots));
+
+    for (u16 i = 0; i < SCHED_MAX_TIMERS; ++i) {
+        sched->nodes[i].next = i + 1 < SCHED_MAX_TIMERS ? i + 1 : SCHED_NIL;
+        sched->nodes[i].gen = 1;
+        sched->nodes[i].fn = NULL;
+    }
+
+    sched->free_head = 0;
+    sched->firing = SCHED_NIL;
+    sched->n_active = 0;
+    sched->now = now_ms;
+}
+
+SchedTimer sched_after(Scheduler* sched, const u64 delay_ms, SchedFn fn, void* user)
+{
+    if (!fn) {
+        util_error("Timer scheduled without a callback");
+        return 0;
+    }
+    if (sched->free_head == SCHED_NIL) {
+        util_error("Timer pool exhausted (%d timers)", SCHED_MAX_TIMERS);
+        return 0;
+    }
+
+    u64 delay = delay_ms;
+    if (delay > SCHED_MAX_DELAY) {
+        util_warn("Clamping timer delay %llu to %llu ms", (unsigned long long)delay, SCHED_MAX_DELAY);
+        delay = SCHED_MAX_DELAY;
+    }
+    // The current tick's slot has already fired, so the earliest a timer can fire is the next one
+    if (delay == 0) delay = 1;
+
+    u16 idx = sched->free_head;
+    SchedNode* node = &sched->nodes[idx];
+    sched->free_head = node->next;
+
+    node->deadline = sched->now + delay;
+    node->fn = fn;
+    node->user = user;
+    sched_link(sched, idx);
+    sched->n_active++;
+
+    return ((u32)node->gen << 16) | idx;
+}
+
+bool sched_cancel(Scheduler* sched, SchedTimer timer)
+{
+    SchedNode* node = sched_lookup(sched, timer);
+    if (!node) {
+        return false;
+    }
+
+    u16 idx = (u16)(node - sched->nodes);
+    sched_unlink(sched, idx);
+    sched_release(sched, idx);
+
+    return true;
+}
+
+void sched_advance(Scheduler* sched, const u64 now_ms)
+{
+    while (sched->now < now_ms) {
+        if (sched->n_active == 0) {
+            // Nothing can fire, so there is no need to walk the ticks in between
+            sched->now = now_ms;
+            return;
+        }
+
+        u64 tick = ++sched->now;
+
+        if ((tick & SCHED_SLOT_MASK) == 0) {
+            // Cascade coarsest first so timers can trickle all the way down in a single tick
+            u8 top = 1;
+            while (top < SCHED_LEVELS - 1 && ((tick >> (SCHED_SLOT_BITS * top)) & SCHED_SLOT_MASK) == 0) {
+                ++top;
+            }
+            for (u8 level = top; level >= 1; --level) {
+                sched_cascade(sched, level);
+            }
+        }
+
+        // The slot list is moved onto the firing list up front so callbacks can freely schedule
+        // timers. Nodes stay linked there until they fire, so a callback cancelling a later timer
+        // in the same tick just unlinks it like any other.
+        u8 slot = tick & SCHED_SLOT_MASK;
+        sched->firing = sched->slots[0][slot];
+        sched->slots[0][slot] = SCHED_NIL;
+        for (u16 idx = sched->firing; idx != SCHED_NIL; idx = sched->nodes[idx].next) {
+            sched->nodes[idx].level = SCHED_FIRING;
+        }
+
+        while (sched->firing != SCHED_NIL) {
+            u16 idx = sched->firing;
+            SchedNode* node = &sched->nodes[idx];
+            SchedFn fn = node->fn;
+            void* user = node->user;
+
+            sched_unlink(sched, idx);
+            sched_release(sched, idx);
+            fn(user);
+        }
+    }
+}
+
+// ------------------------------------------------------------------------------------------------
+
+static void sched_link(Scheduler* sched, u16 idx)
+{
+    SchedNode* node = &sched->nodes[idx];
+    u64 delta = node->deadline - sched->now;
+
+    u8 level = 0;
+    while (level < SCHED_LEVELS - 1 && delta >= (1ULL << (SCHED_SLOT_BITS * (level + 1)))) {
+        ++level;
+    }
+
+    node->level = level;
+    node->slot = (node->deadline >> (SCHED_SLOT_BITS * level)) & SCHED_SLOT_MASK;
+    node->prev = SCHED_NIL;
+    node->next = sched->slots[level][node->slot];
+    if (node->next != SCHED_NIL) {
+        sched->nodes[node->next].prev = idx;
+    }
+    sched->slots[level][node->slot] = idx;
+}
+
+static void sched_unlink(Scheduler* sched, u16 idx)
+{
+    SchedNode* node = &sched->nodes[idx];
+
+    if (node->prev != SCHED_NIL) {
+        sched->nodes[node->prev].next = node->next;
+    } else if (node->level == SCHED_FIRING) {
+        sched->firing = node->next;
+    } else {
+        sched->slots[node->level][node->slot] = node->next;
+    }
+    if (node->next != SCHED_NIL) {
+        sched->nodes[node->next].prev = node->prev;
+    }
+}
+
+static void sched_release(Scheduler* sched, u16 idx)
+{
+    SchedNode* node = &sched->nodes[idx];
+
+    // Bumping the generation invalidates any handles still pointing at this node
+    node->gen = node->gen == 0xffff ? 1 : node->gen + 1;
+    node->fn = NULL;
+    node->next = sched->free_head;
+    sched->free_head = idx;
+    sched->n_active--;
+}
+
+static void sched_cascade(Scheduler* sched, u8 level)
+{
+    u8 slot = (sched->now >> (SCHED_SLOT_BITS * level)) & SCHED_SLOT_MASK;
+    u16 idx = sched->slots[level][slot];
+    sched->slots[level][slot] = SCHED_NIL;
+
+    while (idx != SCHED_NIL) {
+        u16 next = sched->nodes[idx].next;
+        sched_link(sched, idx);
+        idx = next;
+    }
+}
+
+static SchedNode* sched_lookup(Scheduler* sched, SchedTimer timer)
+{
+    u16 idx = timer & 0xffff;
+    u16 gen = timer >> 16;
+
+    if (idx >= SCHED_MAX_TIMERS || gen == 0) {
+        return NULL;
+    }
+
+    SchedNode* node = &sched->nodes[idx];
+    if (node->gen != gen || !node->fn) {
+        return NULL;
+    }
+
+    return node;
+}
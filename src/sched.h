@@ -0,0 +1,50 @@
+#ifndef SCHED_H_
+#define SCHED_H_
+
+#include "utils.h"
+
+#define SCHED_MAX_TIMERS 256
+#define SCHED_LEVELS 4
+#define SCHED_SLOT_BITS 6
+#define SCHED_SLOTS (1 << SCHED_SLOT_BITS)
+#define SCHED_SLOT_MASK (SCHED_SLOTS - 1)
+#define SCHED_MAX_DELAY ((1ULL << (SCHED_SLOT_BITS * SCHED_LEVELS)) - 1)
+#define SCHED_NIL 0xffff
+// Level tag for nodes detached from the wheel and waiting on the firing list
+#define SCHED_FIRING 0xff
+
+typedef void (*SchedFn)(void* user);
+
+// Handle to a scheduled timer: pool index in the low 16 bits, generation in the high 16. A zero
+// handle never refers to a live timer, so it doubles as "not scheduled".
+typedef u32 SchedTimer;
+
+typedef struct {
+    u64 deadline;
+    SchedFn fn;
+    void* user;
+    u16 prev;
+    u16 next;
+    u16 gen;
+    u8 level;
+    u8 slot;
+} SchedNode;
+
+// Hierarchical timer wheel with a 1ms tick. Level n slots span 64^n ticks, so four levels cover
+// ~4.6 hours. Insert and cancel are O(1); each tick fires one level 0 slot and, every 64 ticks,
+// cascades one slot of the level above down into the finer wheel.
+typedef struct {
+    u64 now;
+    u32 n_active;
+    u16 free_head;
+    u16 firing;
+    u16 slots[SCHED_LEVELS][SCHED_SLOTS];
+    SchedNode nodes[SCHED_MAX_TIMERS];
+} Scheduler;
+
+void sched_init(Scheduler* sched, const u64 now_ms);
+SchedTimer sched_after(Scheduler* sched, const u64 delay_ms, SchedFn fn, void* user);
+bool sched_cancel(Scheduler* sched, SchedTimer timer);
+void sched_advance(Scheduler* sched, const u64 now_ms);
+
+#endif // !SCHED_H_
@@ -0,0 +1,130 @@
+#include "snapshot.h"
+#include "utils.h"
+#include <stdio.h>
+#include <string.h>
+
+bool snapshot_init(SnapshotRing* ring, size_t slot_size, u32 cap, const char* name, MemSubsystem subsys)
+{
+    memset(ring, 0, sizeof(*ring));
+
+    // Slots are 16-byte aligned so a memcpy in and out never straddles more lines than it must
+    size_t stride = (slot_size + 15) & ~(size_t)15;
+    size_t bytes = stride * cap + 16 + ARENA_SLACK(1);
+
+    arena_init(&ring->mem, bytes, name, subsys, bytes);
+    ring->slots = arena_alloc_aligned(&ring->mem, stride * cap, 16);
+    if (!ring->slots) {
+        util_error("Error allocating %u snapshot slots of %zu bytes", cap, slot_size);
+        arena_free(&ring->mem);
+        return false;
+    }
+
+    ring->slot_size = slot_size;
+    ring->stride = stride;
+    ring->cap = cap;
+
+    return true;
+}
+
+void snapshot_push(SnapshotRing* ring, const void* src)
+{
+    if (!ring->cap) {
+        return;
+    }
+
+    memcpy(ring->slots + (size_t)ring->head * ring->stride, src, ring->slot_size);
+    ring->head = (ring->head + 1) % ring->cap;
+    if (ring->count < ring->cap) {
+        ++ring->count;
+    }
+}
+
+bool snapshot_pop(SnapshotRing* ring, void* dst)
+{
+    if (!ring->count) {
+        return false;
+    }
+
+    ring->head = (ring->head + ring->cap - 1) % ring->cap;
+    --ring->count;
+    memcpy(dst, ring->slots + (size_t)ring->head * ring->stride, ring->slot_size);
+
+    return true;
+}
+
+void snapshot_clear(SnapshotRing* ring)
+{
+    ring->head = 0;
+    ring->count = 0;
+}
+
+void snapshot_destroy(SnapshotRing* ring)
+{
+    if (ring->slots) {
+        arena_free(&ring->mem);
+    }
+    memset(ring, 0, sizeof(*ring));
+}
+
+bool snapshot_save(const char* path, const void* src, size_t size, u32 version)
+{
+    // Write to a sibling and rename over the target so a crash mid-save never leaves a torn file
+    char tmp_path[FPATH_MAX];
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path);
+
+    FILE* f = fopen(tmp_path, "wb");
+    if (!f) {
+        util_error("Error opening save-state %s for writing", tmp_path);
+        return false;
+    }
+
+    SnapshotHeader hdr = {SNAPSHOT_MAGIC, version, (u32)size, 0};
+    bool ok = fwrite(&hdr, sizeof(hdr), 1, f) == 1 && fwrite(src, size, 1, f) == 1;
+    ok = fclose(f) == 0 && ok;
+
+    if (!ok || rename(tmp_path, path) != 0) {
+        util_error("Error writing save-state %s", path);
+        remove(tmp_path);
+        return false;
+    }
+
+    return true;
+}
+
+bool snapshot_load(const char* path, void* dst, size_t size, u32 version)
+{
+    FILE* f = fopen(path, "rb");
+    if (!f) {
+        util_error("Error opening save-state %s", path);
+        return false;
+    }
+
+    SnapshotHeader hdr;
+    if (fread(&hdr, sizeof(hdr), 1, f) != 1) {
+        util_error("Error reading save-state header from %s", path);
+        fclose(f);
+        return false;
+    }
+    if (hdr.magic != SNAPSHOT_MAGIC || hdr.version != version || hdr.size != size) {
+        util_error("Bad save-state header in %s: magic=0x%x version=%u size=%u", path, hdr.magic, hdr.version, hdr.size);
+        fclose(f);
+        return false;
+    }
+
+    // Check the whole payload is there before touching the caller's block, so a truncated file
+    // can't leave it half overwritten
+    long start = ftell(f);
+    if (fseek(f, 0, SEEK_END) != 0 || ftell(f) - start != (long)size || fseek(f, start, SEEK_SET) != 0) {
+        util_error("Truncated save-state %s", path);
+        fclose(f);
+        return false;
+    }
+
+    bool ok = fread(dst, size, 1, f) == 1;
+    fclose(f);
+    if (!ok) {
+        util_error("Error reading save-state %s", path);
+    }
+
+    return ok;
+}
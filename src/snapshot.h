@@ -0,0 +1,40 @@
+#ifndef SNAPSHOT_H_
+#define SNAPSHOT_H_
+
+#include "arena.h"
+#include "utils.h"
+
+#define SNAPSHOT_MAGIC 0x50414e53 // "SNAP" little-endian
+
+// A fixed ring of equally sized slots, preallocated up front. Pushing is one memcpy into the next
+// slot, overwriting the oldest once full, and popping hands back the newest, so it doubles as an
+// undo stack for rewind. The ring knows nothing about what it stores beyond the slot size; callers
+// must only push pointer-free blocks.
+typedef struct {
+    MemoryArena mem;
+    unsigned char* slots;
+    size_t slot_size;
+    size_t stride;
+    u32 cap;
+    u32 head; // Next slot to write
+    u32 count;
+} SnapshotRing;
+
+// Raw save-state header. The payload follows straight after and is the block's bytes as-is in host
+// byte order, so a file only loads back into a build with the same layout `version` and `size`.
+typedef struct {
+    u32 magic;
+    u32 version;
+    u32 size;
+    u32 reserved;
+} SnapshotHeader;
+
+bool snapshot_init(SnapshotRing* ring, size_t slot_size, u32 cap, const char* name, MemSubsystem subsys);
+void snapshot_push(SnapshotRing* ring, const void* src);
+bool snapshot_pop(SnapshotRing* ring, void* dst);
+void snapshot_clear(SnapshotRing* ring);
+void snapshot_destroy(SnapshotRing* ring);
+bool snapshot_save(const char* path, const void* src, size_t size, u32 version);
+bool snapshot_load(const char* path, void* dst, size_t size, u32 version);
+
+#endif // !SNAPSHOT_H_
@@ -0,0 +1,173 @@
+#define _DEFAULT_SOURCE
+#include "soak.h"
+#include "memreg.h"
+#include "utils.h"
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+static size_t soak_rss(void);
+static void soak_arena_bytes(size_t* current, size_t* committed);
+static bool soak_check_growth(const Soak* soak, const char* name, size_t offset);
+static size_t soak_value(const Soak* soak, u32 sample, size_t offset);
+
+void soak_init(Soak* soak, u64 max_frames)
+{
+    memset(soak, 0, sizeof(*soak));
+
+    soak->max_frames = max_frames ? max_frames : 1;
+    soak->sample_every = soak->max_frames / SOAK_MAX_SAMPLES;
+    if (soak->sample_every == 0) {
+        soak->sample_every = 1;
+    }
+
+    util_info("soak: %llu frames, sampling every %llu",
+              (unsigned long long)soak->max_frames,
+              (unsigned long long)soak->sample_every);
+}
+
+void soak_frame(Soak* soak, f64 frame_ms)
+{
+    if (soak->done) {
+        return;
+    }
+
+    soak->window_ms += frame_ms;
+    ++soak->frames;
+
+    if (soak->frames % soak->sample_every == 0 && soak->n_samples < SOAK_MAX_SAMPLES) {
+        SoakSample* sample = &soak->samples[soak->n_samples++];
+        *sample = (SoakSample){
+            .frame = soak->frames,
+            .rss = soak_rss(),
+            .live_allocs = util_live_allocs(),
+            .frame_ms = soak->window_ms / (f64)soak->sample_every,
+        };
+        soak_arena_bytes(&sample->arena_current, &sample->arena_committed);
+        soak->window_ms = 0.0;
+    }
+
+    if (soak->frames >= soak->max_frames) {
+        soak->done = true;
+    }
+}
+
+// Returns false if any memory series kept growing; frame time drift past SOAK_DRIFT_PCT only warns
+bool soak_report(const Soak* soak)
+{
+    if (soak->n_samples <= SOAK_WARMUP_SAMPLES + 1) {
+        util_warn("soak: only %u samples, too few to judge growth", soak->n_samples);
+        return true;
+    }
+
+    const SoakSample* first = &soak->samples[SOAK_WARMUP_SAMPLES];
+    const SoakSample* last = &soak->samples[soak->n_samples - 1];
+
+    util_info("soak: %llu frames, %u samples", (unsigned long long)soak->frames, soak->n_samples);
+    util_info("  %-12s %14s %14s", "", "start", "end");
+    util_info("  %-12s %14zu %14zu", "rss", first->rss, last->rss);
+    util_info("  %-12s %14zu %14zu", "live_allocs", first->live_allocs, last->live_allocs);
+    util_info("  %-12s %14zu %14zu", "arena_used", first->arena_current, last->arena_current);
+    util_info("  %-12s %14zu %14zu", "arena_commit", first->arena_committed, last->arena_committed);
+    util_info("  %-12s %14.4f %14.4f", "frame_ms", first->frame_ms, last->frame_ms);
+
+    bool ok = true;
+    ok &= soak_check_growth(soak, "rss", offsetof(SoakSample, rss));
+    ok &= soak_check_growth(soak, "live_allocs", offsetof(SoakSample, live_allocs));
+    ok &= soak_check_growth(soak, "arena_used", offsetof(SoakSample, arena_current));
+    ok &= soak_check_growth(soak, "arena_commit", offsetof(SoakSample, arena_committed));
+
+    // Single windows are noisy, so compare the mean of the first and last quarters of the run
+    u32 n = soak->n_samples - SOAK_WARMUP_SAMPLES;
+    u32 q = n / 4 ? n / 4 : 1;
+    f64 head = 0.0, tail = 0.0;
+    for (u32 i = 0; i < q; ++i) {
+        head += first[i].frame_ms;
+        tail += last[-(i32)i].frame_ms;
+    }
+    f64 drift = head > 0.0 ? (tail - head) / head * 100.0 : 0.0;
+    if (drift > SOAK_DRIFT_PCT) {
+        // Uncapped wall-clock frame time is at the mercy of whatever else the machine is doing, so
+        // drift is reported but only memory growth fails the run
+        util_warn("soak: frame time drifted %+.1f%% (%.4fms -> %.4fms)", drift, head / q, tail / q);
+    } else {
+        util_info("soak: frame time drift %+.1f%%", drift);
+    }
+
+    util_info("soak: %s", ok ? "no growth detected" : "GROWTH DETECTED");
+
+    return ok;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+static size_t soak_rss(void)
+{
+#ifdef __linux__
+    // statm is in pages: total program size, then resident set
+    FILE* f = fopen("/proc/self/statm", "r");
+    if (!f) {
+        return 0;
+    }
+
+    unsigned long size = 0, resident = 0;
+    int n = fscanf(f, "%lu %lu", &size, &resident);
+    fclose(f);
+
+    return n == 2 ? (size_t)resident * (size_t)sysconf(_SC_PAGESIZE) : 0;
+#else
+    return 0;
+#endif
+}
+
+// Bytes in use and bytes reserved across every registered arena right now. Peaks are no good here:
+// they can only ever rise, so they would flag a one-off spike the same as a leak.
+static void soak_arena_bytes(size_t* current, size_t* committed)
+{
+    *current = 0;
+    *committed = 0;
+    for (u32 s = 0; s < MEM_SUBSYS_COUNT; ++s) {
+        const MemSubsysStats* stats = memreg_subsys(s);
+        *current += stats->current;
+        *committed += stats->committed;
+    }
+}
+
+// A series counts as growing if it never went down after warmup and rose in every one of
+// SOAK_GROWTH_WINDOWS equal windows across the second half of the run. A pool that steps up once or
+// twice and then plateaus is not a leak.
+static bool soak_check_growth(const Soak* soak, const char* name, size_t offset)
+{
+    u32 mid = SOAK_WARMUP_SAMPLES + (soak->n_samples - SOAK_WARMUP_SAMPLES) / 2;
+    u32 window = (soak->n_samples - 1 - mid) / SOAK_GROWTH_WINDOWS;
+    if (window == 0) {
+        return true;
+    }
+
+    size_t prev = 0;
+    for (u32 i = SOAK_WARMUP_SAMPLES; i < soak->n_samples; ++i) {
+        size_t v = soak_value(soak, i, offset);
+        if (i > SOAK_WARMUP_SAMPLES && v < prev) {
+            return true;
+        }
+        prev = v;
+    }
+
+    for (u32 w = 0; w < SOAK_GROWTH_WINDOWS; ++w) {
+        if (soak_value(soak, mid + (w + 1) * window, offset) <= soak_value(soak, mid + w * window, offset)) {
+            return true;
+        }
+    }
+
+    util_warn("soak: %s grew in all %d windows of the second half, %zu -> %zu",
+              name,
+              SOAK_GROWTH_WINDOWS,
+              soak_value(soak, SOAK_WARMUP_SAMPLES, offset),
+              prev);
+    return false;
+}
+
+static size_t soak_value(const Soak* soak, u32 sample, size_t offset)
+{
+    return *(const size_t*)((const unsigned char*)&soak->samples[sample] + offset);
+}
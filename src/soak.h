@@ -0,0 +1,38 @@
+#ifndef SOAK_H_
+#define SOAK_H_
+
+#include "utils.h"
+
+#define SOAK_MAX_SAMPLES 1024
+#define SOAK_WARMUP_SAMPLES 4 // Skipped before judging growth, while pools and caches fill
+#define SOAK_DRIFT_PCT 10.0
+#define SOAK_GROWTH_WINDOWS 4 // A leak must rise in every one of this many windows of the second half
+
+typedef struct {
+    u64 frame;
+    size_t rss;
+    size_t live_allocs;
+    size_t arena_current;
+    size_t arena_committed;
+    f64 frame_ms; // Mean over the frames since the previous sample
+} SoakSample;
+
+// Long-run leak and slowdown harness. Runs a fixed number of frames, sampling process RSS, live
+// tracked allocations, bytes in use and committed across all arenas, and mean frame time at evenly
+// spaced points, then reports any series that kept growing, and how far frame time drifted from
+// the start of the run.
+typedef struct {
+    u64 max_frames;
+    u64 frames;
+    u64 sample_every;
+    f64 window_ms;
+    SoakSample samples[SOAK_MAX_SAMPLES];
+    u32 n_samples;
+    bool done;
+} Soak;
+
+void soak_init(Soak* soak, u64 max_frames);
+void soak_frame(Soak* soak, f64 frame_ms);
+bool soak_report(const Soak* soak);
+
+#endif // !SOAK_H_
@@ -0,0 +1,238 @@
+#include "stress.h"
+#include "arena.h"
+#include "game.h"
+#include "gfx.h"
+#include "utils.h"
+#include <SDL3/SDL_render.h>
+#include <SDL3/SDL_timer.h>
+#include <string.h>
+
+#define STRESS_BATCH_VERTS 65536
+#define STRESS_PULSE_RATE 1.5f
+
+static void stress_layout(StressScene* scene, u32 n_boards);
+static void stress_record_frame(StressScene* scene);
+
+static const char* path_names[STRESS_PATH_COUNT] = {
+    "per-sector",
+    "batched",
+};
+
+bool stress_init(StressScene* scene, u32 max_boards, const TuningData* tuning)
+{
+    memset(scene, 0, sizeof(*scene));
+
+    if (max_boards < 1) max_boards = 1;
+    if (max_boards > STRESS_MAX_BOARDS) max_boards = STRESS_MAX_BOARDS;
+
+    size_t per_board = sizeof(f32) * 3 + sizeof(u32) + sizeof(u8) + sizeof(Rules);
+    arena_init(&scene->mem, max_boards * per_board + 16 * 6 + ARENA_SLACK(6), "gfx.stress_boards", MEM_SUBSYS_GFX, 0);
+    if (!scene->mem.base) {
+        return false;
+    }
+
+    scene->cx = (f32*)arena_alloc_aligned(&scene->mem, sizeof(f32) * max_boards, 16);
+    scene->cy = (f32*)arena_alloc_aligned(&scene->mem, sizeof(f32) * max_boards, 16);
+    scene->pulse = (f32*)arena_alloc_aligned(&scene->mem, sizeof(f32) * max_boards, 16);
+    scene->wait_ms = (u32*)arena_alloc_aligned(&scene->mem, sizeof(u32) * max_boards, 16);
+    scene->lit = (u8*)arena_alloc_aligned(&scene->mem, sizeof(u8) * max_boards, 16);
+    scene->rules = (Rules*)arena_alloc_aligned(&scene->mem, sizeof(Rules) * max_boards, 16);
+    if (!scene->rules) {
+        arena_free(&scene->mem);
+        return false;
+    }
+
+    if (!gfx_batch_init(&scene->batch, STRESS_BATCH_VERTS)) {
+        arena_free(&scene->mem);
+        return false;
+    }
+
+    for (u32 i = 0; i < max_boards; ++i) {
+        scene->pulse[i] = 1.0f;
+        rules_seed(&scene->rules[i], 0x9e3779b9u * (i + 1));
+        rules_new_game(&scene->rules[i]);
+        scene->rules[i] = rules_step(&scene->rules[i], (RulesInput){.pressed = RULES_NO_QUAD}, 0, tuning);
+        scene->lit[i] = RULES_NO_QUAD;
+        // Stagger the boards so they don't all light up on the same frame
+        scene->wait_ms[i] = scene->rules[i].timer_ms + (scene->rules[i].rng >> 8) % 1000;
+    }
+
+    scene->max_boards = max_boards;
+    scene->path = STRESS_PATH_SECTOR;
+    stress_layout(scene, 1);
+
+    util_info("stress: sweeping 1..%u boards, %d warmup + %d sampled frames per step",
+              max_boards,
+              STRESS_WARMUP_FRAMES,
+              STRESS_SAMPLE_FRAMES);
+
+    return true;
+}
+
+void stress_update(StressScene* scene, const f64 dt, const TuningData* tuning)
+{
+    if (scene->done) {
+        return;
+    }
+
+    stress_record_frame(scene);
+
+    u32 n = scene->n_boards;
+    f32 fdt = (f32)dt;
+    u32 dt_ms = (u32)(dt * SECOND + 0.5);
+
+    // Countdown and pulse decay are branch-free so they vectorise
+    for (u32 i = 0; i < n; ++i) {
+        u32 wait = scene->wait_ms[i];
+        scene->wait_ms[i] = wait > dt_ms ? wait - dt_ms : 0;
+        scene->pulse[i] = fmaxf(scene->pulse[i] - STRESS_PULSE_RATE * fdt, 1.0f);
+    }
+
+    for (u32 i = 0; i < n; ++i) {
+        if (scene->wait_ms[i]) {
+            continue;
+        }
+
+        Rules* rules = &scene->rules[i];
+
+        RulesInput in = {.pressed = RULES_NO_QUAD};
+        if (rules->phase == RULES_INPUT) {
+            in.pressed = rules->seq.quads[rules->pos];
+        }
+
+        // Stepped event to event like the batch simulator: whatever the game was waiting on is due
+        *rules = rules_step(rules, in, rules->timer_ms, tuning);
+
+        if (rules->events & (RULES_EV_LIGHT | RULES_EV_PRESS)) {
+            scene->pulse[i] = 1.5f;
+        }
+        if (rules->phase == RULES_WON || rules->phase == RULES_LOST) {
+            rules_new_game(rules);
+        }
+
+        scene->lit[i] = rules->lit;
+        scene->wait_ms[i] = rules->phase == RULES_SHOW ? rules->timer_ms : 0;
+    }
+}
+
+void stress_render(StressScene* scene, SDL_Renderer* renderer, const TuningData* tuning)
+{
+    u32 n = scene->n_boards;
+    f32 r = scene->board_radius;
+    u16 segs = scene->segs_per_quarter;
+
+    // Read from the tuning image each frame, so the scene follows hot reloads like the game does
+    SDL_FColor colours[QUAD_COUNT];
+    SDL_FColor hi_colours[QUAD_COUNT];
+    for (u8 q = 0; q < QUAD_COUNT; ++q) {
+        const TuningColour* c = &tuning->colours[q];
+        const TuningColour* hi = &tuning->hi_colours[q];
+        colours[q] = (SDL_FColor){c->r, c->g, c->b, c->a};
+        hi_colours[q] = (SDL_FColor){hi->r, hi->g, hi->b, hi->a};
+    }
+
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_NONE);
+
+    for (u32 i = 0; i < n; ++i) {
+        f32 pr = r * scene->pulse[i];
+
+        for (u8 q = 0; q < QUAD_COUNT; ++q) {
+            f32 start = (float)q * (M_PI / 2.0f);
+            f32 end = (float)(q + 1) * (M_PI / 2.0f);
+            bool lit = scene->lit[i] == q;
+            SDL_FColor colour = lit ? hi_colours[q] : colours[q];
+            f32 qr = lit ? pr : r;
+
+            if (scene->path == STRESS_PATH_SECTOR) {
+                render_sector(renderer, scene->cx[i], scene->cy[i], qr, start, end, segs, colour);
+            } else {
+                gfx_batch_sector(&scene->batch, renderer, scene->cx[i], scene->cy[i], qr, start, end, segs, colour);
+            }
+        }
+    }
+
+    if (scene->path == STRESS_PATH_BATCHED) {
+        gfx_batch_flush(&scene->batch, renderer);
+    }
+
+    SDL_SetRenderDrawColor(renderer, 0x00, 0x00, 0x00, 0xff);
+    SDL_RenderDebugTextFormat(renderer, 10.0f, 24.0f, "stress: %u boards, %s", n, path_names[scene->path]);
+}
+
+void stress_destroy(StressScene* scene)
+{
+    gfx_batch_free(&scene->batch);
+    arena_free(&scene->mem);
+}
+
+// ------------------------------------------------------------------------------------------------
+
+static void stress_layout(StressScene* scene, u32 n_boards)
+{
+    u32 cols = 1;
+    while (cols * cols < n_boards) {
+        ++cols;
+    }
+    u32 rows = (n_boards + cols - 1) / cols;
+
+    f32 cell_w = (f32)WINDOW_WIDTH / (f32)cols;
+    f32 cell_h = (f32)WINDOW_HEIGHT / (f32)rows;
+    f32 cell = fminf(cell_w, cell_h);
+
+    for (u32 i = 0; i < n_boards; ++i) {
+        scene->cx[i] = cell_w * ((f32)(i % cols) + 0.5f);
+        scene->cy[i] = cell_h * ((f32)(i / cols) + 0.5f);
+    }
+
+    // Leave room for the 1.5x pulse and drop tessellation once boards shrink to a few pixels
+    scene->board_radius = cell / 3.0f;
+    scene->segs_per_quarter = (u16)clamp_f(scene->board_radius / 4.0f, 2.0f, 40.0f);
+    scene->n_boards = n_boards;
+}
+
+static void stress_record_frame(StressScene* scene)
+{
+    u64 now = SDL_GetPerformanceCounter();
+    f64 frame_ms = (f64)(now - scene->prev_counter) * 1000.0 / (f64)SDL_GetPerformanceFrequency();
+    scene->prev_counter = now;
+
+    u32 frame = scene->frame++;
+    if (frame <= STRESS_WARMUP_FRAMES) {
+        // Frame 0 has no predecessor, and the rest let caches and the driver settle
+        scene->batch.nflushes = 0;
+        return;
+    }
+
+    scene->sample_total_ms += frame_ms;
+    if (frame_ms > scene->sample_max_ms) scene->sample_max_ms = frame_ms;
+
+    if (frame < STRESS_WARMUP_FRAMES + STRESS_SAMPLE_FRAMES) {
+        return;
+    }
+
+    util_info("stress: n=%6u path=%-10s avg=%8.3fms max=%8.3fms draws/frame=%u",
+              scene->n_boards,
+              path_names[scene->path],
+              scene->sample_total_ms / STRESS_SAMPLE_FRAMES,
+              scene->sample_max_ms,
+              scene->path == STRESS_PATH_SECTOR ? scene->n_boards * QUAD_COUNT
+                                                : scene->batch.nflushes / STRESS_SAMPLE_FRAMES);
+
+    scene->frame = 0;
+    scene->sample_total_ms = 0.0;
+    scene->sample_max_ms = 0.0;
+
+    if (++scene->path < STRESS_PATH_COUNT) {
+        return;
+    }
+    scene->path = STRESS_PATH_SECTOR;
+
+    if (scene->n_boards >= scene->max_boards) {
+        util_info("stress: sweep complete");
+        scene->done = true;
+        return;
+    }
+
+    u32 next = scene->n_boards * 10;
+    stress_layout(scene, next > scene->max_boards ? scene->max_boards : next);
+}
@@ -0,0 +1,55 @@
+#ifndef STRESS_H_
+#define STRESS_H_
+
+#include "arena.h"
+#include "gfx.h"
+#include "rules.h"
+#include "tuning.h"
+#include <SDL3/SDL.h>
+
+#define STRESS_MAX_BOARDS 100000
+#define STRESS_WARMUP_FRAMES 30
+#define STRESS_SAMPLE_FRAMES 120
+
+typedef enum {
+    STRESS_PATH_SECTOR,
+    STRESS_PATH_BATCHED,
+    STRESS_PATH_COUNT,
+} StressPath;
+
+// Every board plays a full game through the rules core, with a perfect player repeating each
+// sequence back, so per-board state and memory traffic match N real games. What every tick reads
+// (countdown, lit quad, pulse, position) lives in parallel arrays walked linearly; a board's Rules
+// is only touched when its countdown runs out and the game has something to do.
+typedef struct {
+    u32 n_boards;
+    u32 max_boards;
+
+    f32* cx;
+    f32* cy;
+    f32* pulse;
+    u32* wait_ms; // Until the board's game next needs stepping
+    u8* lit;
+    Rules* rules;
+
+    f32 board_radius;
+    u16 segs_per_quarter;
+
+    // Sweep bookkeeping: each (n_boards, path) pair is warmed up then sampled
+    StressPath path;
+    u32 frame;
+    u64 prev_counter;
+    f64 sample_total_ms;
+    f64 sample_max_ms;
+    bool done;
+
+    MemoryArena mem;
+    GfxBatch batch;
+} StressScene;
+
+bool stress_init(StressScene* scene, u32 max_boards, const TuningData* tuning);
+void stress_update(StressScene* scene, const f64 dt, const TuningData* tuning);
+void stress_render(StressScene* scene, SDL_Renderer* renderer, const TuningData* tuning);
+void stress_destroy(StressScene* scene);
+
+#endif // !STRESS_H_
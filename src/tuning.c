@@ -0,0 +1,275 @@
+#define _DEFAULT_SOURCE
+#include "tuning.h"
+#include "utils.h"
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#endif
+
+static bool tuning_map(Tuning* tuning);
+static void tuning_watch(Tuning* tuning);
+static bool tuning_valid_secs(f32 secs);
+static bool tuning_valid_colour(const TuningColour* colour);
+
+// Matches the behaviour the game shipped with before tuning files: level n shows n*4 moves at a
+// 2000/n ms interval, up to MAX_MOVES
+static TuningData defaults;
+static bool defaults_ready = false;
+
+bool tuning_validate(const TuningData* data, size_t size)
+{
+    if (size < sizeof(TuningData)) {
+        util_error("Tuning data too small: %zu < %zu", size, sizeof(TuningData));
+        return false;
+    }
+    if (data->magic != TUNING_MAGIC || data->version != TUNING_VERSION || data->size != sizeof(TuningData)) {
+        util_error("Bad tuning header: magic=0x%x version=%u size=%u", data->magic, data->version, data->size);
+        return false;
+    }
+    if (data->max_moves == 0 || data->max_moves > TUNING_MAX_MOVES) {
+        util_error("Bad tuning max_moves: %u (limit %u)", data->max_moves, TUNING_MAX_MOVES);
+        return false;
+    }
+    if (!tuning_valid_secs(data->pulse_secs) || !tuning_valid_secs(data->tone_secs)) {
+        util_error("Bad tuning effect length: pulse_secs=%g tone_secs=%g (must be in (0, %g])",
+                   (f64)data->pulse_secs,
+                   (f64)data->tone_secs,
+                   (f64)TUNING_MAX_EFFECT_SECS);
+        return false;
+    }
+    for (u32 i = 0; i < TUNING_QUADS; ++i) {
+        if (!tuning_valid_colour(&data->colours[i]) || !tuning_valid_colour(&data->hi_colours[i])) {
+            util_error("Bad tuning colour for quad %u: components must be in [0, 1]", i);
+            return false;
+        }
+    }
+    if (data->n_levels == 0 || data->n_levels > TUNING_MAX_LEVELS) {
+        util_error("Bad tuning level count: %u", data->n_levels);
+        return false;
+    }
+    for (u32 i = 0; i < data->n_levels; ++i) {
+        if (data->levels[i].moves == 0 || data->levels[i].moves > data->max_moves) {
+            util_error("Bad tuning level %u: moves=%u max_moves=%u", i + 1, data->levels[i].moves, data->max_moves);
+            return false;
+        }
+        if (data->levels[i].show_interval_ms < TUNING_MIN_SHOW_INTERVAL_MS) {
+            util_error("Bad tuning level %u: show_interval_ms=%u is under %u",
+                       i + 1,
+                       data->levels[i].show_interval_ms,
+                       TUNING_MIN_SHOW_INTERVAL_MS);
+            return false;
+        }
+    }
+    return true;
+}
+
+const TuningData* tuning_defaults(void)
+{
+    if (defaults_ready) {
+        return &defaults;
+    }
+
+    static const TuningColour colours[TUNING_QUADS] = {
+        {1.0f, 0.3f, 0.3f, 1.0f}, // red
+        {0.3f, 1.0f, 0.3f, 1.0f}, // green
+        {0.3f, 0.3f, 1.0f, 1.0f}, // blue
+        {1.0f, 1.0f, 0.3f, 1.0f}  // yellow
+    };
+    static const TuningColour hi_colours[TUNING_QUADS] = {
+        {1.0f, 0.6f, 0.6f, 1.0f}, // lighter red
+        {0.6f, 1.0f, 0.6f, 1.0f}, // lighter green
+        {0.6f, 0.6f, 1.0f, 1.0f}, // lighter blue
+        {1.0f, 1.0f, 0.6f, 1.0f}  // lighter yellow
+    };
+
+    memset(&defaults, 0, sizeof(defaults));
+    defaults.magic = TUNING_MAGIC;
+    defaults.version = TUNING_VERSION;
+    defaults.size = sizeof(TuningData);
+    defaults.max_moves = TUNING_MAX_MOVES;
+    defaults.pulse_secs = 0.1f;
+    defaults.tone_secs = 0.3f;
+    memcpy(defaults.colours, colours, sizeof(colours));
+    memcpy(defaults.hi_colours, hi_colours, sizeof(hi_colours));
+
+    for (u32 level = 1; level <= TUNING_MAX_LEVELS && level * TUNING_QUADS <= defaults.max_moves; ++level) {
+        defaults.levels[level - 1].moves = level * TUNING_QUADS;
+        defaults.levels[level - 1].show_interval_ms = 2 * SECOND / level;
+        defaults.n_levels = level;
+    }
+
+    defaults_ready = true;
+
+    return &defaults;
+}
+
+bool tuning_open(Tuning* tuning, const char* path)
+{
+    memset(tuning, 0, sizeof(*tuning));
+    snprintf(tuning->path, sizeof(tuning->path), "%s", path);
+    tuning->data = tuning_defaults();
+    tuning->watch_fd = -1;
+
+    tuning_watch(tuning);
+
+    if (!tuning_map(tuning)) {
+        util_warn("Using built-in tuning; '%s' not loaded", path);
+        return false;
+    }
+
+    return true;
+}
+
+bool tuning_poll(Tuning* tuning)
+{
+    bool changed = false;
+
+#ifdef __linux__
+    if (tuning->watch_fd >= 0) {
+        // Non-blocking: with nothing pending this is a single read() returning EAGAIN
+        _Alignas(struct inotify_event) char buf[sizeof(struct inotify_event) + FPATH_MAX];
+        const char* fname = strrchr(tuning->path, '/');
+        fname = fname ? fname + 1 : tuning->path;
+
+        ssize_t n;
+        while ((n = read(tuning->watch_fd, buf, sizeof(buf))) > 0) {
+            for (char* p = buf; p < buf + n;) {
+                struct inotify_event* ev = (struct inotify_event*)p;
+                if (ev->len && strcmp(ev->name, fname) == 0) {
+                    changed = true;
+                }
+                p += sizeof(struct inotify_event) + ev->len;
+            }
+        }
+    }
+#else
+    struct stat st;
+    if (stat(tuning->path, &st) == 0 && (i64)st.st_mtime != tuning->mtime) {
+        changed = true;
+    }
+#endif
+
+    if (!changed) {
+        return false;
+    }
+
+    if (!tuning_map(tuning)) {
+        util_warn("Keeping previous tuning; reload of '%s' failed", tuning->path);
+        return false;
+    }
+
+    util_info("Reloaded tuning from '%s' (generation %u)", tuning->path, tuning->generation);
+
+    return true;
+}
+
+void tuning_close(Tuning* tuning)
+{
+    if (tuning->map) {
+        munmap(tuning->map, tuning->map_size);
+        tuning->map = NULL;
+    }
+    if (tuning->watch_fd >= 0) {
+        close(tuning->watch_fd);
+        tuning->watch_fd = -1;
+    }
+    tuning->data = tuning_defaults();
+}
+
+// ------------------------------------------------------------------------------------------------
+
+static bool tuning_map(Tuning* tuning)
+{
+    int fd = open(tuning->path, O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(TuningData)) {
+        util_error("Tuning file '%s' is truncated", tuning->path);
+        close(fd);
+        return false;
+    }
+
+    size_t size = (size_t)st.st_size;
+    void* map = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        util_error("Error mapping '%s'", tuning->path);
+        return false;
+    }
+
+    if (!tuning_validate((const TuningData*)map, size)) {
+        munmap(map, size);
+        return false;
+    }
+
+    // The converter renames a complete file into place, so the new mapping is never half written.
+    // Readers only go through tuning->data on the game thread, so the swap is the whole handover.
+    void* old_map = tuning->map;
+    size_t old_size = tuning->map_size;
+
+    tuning->map = map;
+    tuning->map_size = size;
+    tuning->data = (const TuningData*)map;
+    tuning->mtime = (i64)st.st_mtime;
+    tuning->generation++;
+
+    if (old_map) {
+        munmap(old_map, old_size);
+    }
+
+    return true;
+}
+
+static void tuning_watch(Tuning* tuning)
+{
+#ifdef __linux__
+    char dir[FPATH_MAX];
+    snprintf(dir, sizeof(dir), "%s", tuning->path);
+    char* slash = strrchr(dir, '/');
+    if (slash) {
+        *slash = '\0';
+    } else {
+        snprintf(dir, sizeof(dir), ".");
+    }
+
+    // Watch the directory rather than the file: an atomic rename replaces the inode we'd be watching
+    tuning->watch_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (tuning->watch_fd < 0) {
+        util_warn("inotify unavailable; tuning hot reload disabled");
+        return;
+    }
+    if (inotify_add_watch(tuning->watch_fd, dir, IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+        util_warn("Can't watch '%s'; tuning hot reload disabled", dir);
+        close(tuning->watch_fd);
+        tuning->watch_fd = -1;
+    }
+#else
+    (void)tuning;
+#endif
+}
+
+// NaN fails both comparisons, so this also rejects it
+static bool tuning_valid_secs(f32 secs)
+{
+    return secs > 0.0f && secs <= TUNING_MAX_EFFECT_SECS;
+}
+
+static bool tuning_valid_colour(const TuningColour* colour)
+{
+    const f32 c[4] = {colour->r, colour->g, colour->b, colour->a};
+    for (u32 i = 0; i < 4; ++i) {
+        if (!(c[i] >= 0.0f && c[i] <= 1.0f)) {
+            return false;
+        }
+    }
+    return true;
+}
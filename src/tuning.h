@@ -0,0 +1,61 @@
+#ifndef TUNING_H_
+#define TUNING_H_
+
+#include "utils.h"
+
+#define TUNING_MAGIC 0x4e55544d // "MTUN" little-endian
+#define TUNING_VERSION 1
+#define TUNING_MAX_LEVELS 32
+#define TUNING_QUADS 4
+// Longest sequence a tuning image may ask for; the rules core keeps sequences in a buffer this size
+#define TUNING_MAX_MOVES 100
+// Shortest show interval accepted, about three frames; anything less flashes past unseen
+#define TUNING_MIN_SHOW_INTERVAL_MS 50
+// Longest pulse or tone accepted; both feed timers and sample counts, so they must stay sane
+#define TUNING_MAX_EFFECT_SECS 5.0f
+#define TUNING_DEFAULT_PATH "assets/tuning.bin"
+
+typedef struct {
+    f32 r;
+    f32 g;
+    f32 b;
+    f32 a;
+} TuningColour;
+
+typedef struct {
+    u32 moves;
+    u32 show_interval_ms;
+} TuningLevel;
+
+// On-disk layout, used in place straight out of the mapping: a fixed-size, pointer-free block in
+// host byte order. Anything that changes this struct must bump TUNING_VERSION.
+typedef struct {
+    u32 magic;
+    u32 version;
+    u32 size;
+    u32 n_levels;
+    u32 max_moves;
+    f32 pulse_secs;
+    f32 tone_secs;
+    TuningColour colours[TUNING_QUADS];
+    TuningColour hi_colours[TUNING_QUADS];
+    TuningLevel levels[TUNING_MAX_LEVELS];
+} TuningData;
+
+typedef struct {
+    const TuningData* data;
+    void* map;
+    size_t map_size;
+    char path[FPATH_MAX];
+    int watch_fd;
+    i64 mtime;
+    u32 generation;
+} Tuning;
+
+bool tuning_validate(const TuningData* data, size_t size);
+const TuningData* tuning_defaults(void);
+bool tuning_open(Tuning* tuning, const char* path);
+bool tuning_poll(Tuning* tuning);
+void tuning_close(Tuning* tuning);
+
+#endif // !TUNING_H_
@@ -5,6 +5,8 @@
 
 static MemLog mlog[MAX_MEM_LOGS];
 static size_t mlogCount = 0;
+// Unlike the mlog this is kept whether or not DEBUG is set, so long runs can watch it cheaply
+static size_t liveAllocs = 0;
 // static pthread_mutex_t mlogMutex = PTHREAD_MUTEX_INITIALIZER;
 
 static void add_log(void* ptr, const char* fname, unsigned int lnum);
@@ -17,6 +19,7 @@ void* util_malloc(size_t size, const char* fname, unsigned int lnum)
         util_error("malloc failed at %s:%u (size=%zu)\n", fname, lnum, size);
         return NULL;
     }
+    ++liveAllocs;
 
     if (getenv("DEBUG")) {
         // pthread_mutex_lock(&mlogMutex);
@@ -36,6 +39,7 @@ void util_free(void* ptr, const char* fname, unsigned int lnum)
     }
 
     free(ptr);
+    --liveAllocs;
 
     if (getenv("DEBUG")) {
         // pthread_mutex_lock(&mlogMutex);
@@ -45,6 +49,11 @@ void util_free(void* ptr, const char* fname, unsigned int lnum)
     }
 }
 
+size_t util_live_allocs(void)
+{
+    return liveAllocs;
+}
+
 void util_inf(const char* fmt, ...)
 {
     va_list ap;
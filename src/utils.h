@@ -47,6 +47,7 @@ void util_err(const char* fmt, ...);
 void util_fat(const char* fmt, ...);
 void* util_malloc(size_t size, const char* fname, unsigned int lnum);
 void util_free(void* ptr, const char* fname, unsigned int lnum);
+size_t util_live_allocs(void);
 
 // ------------------------------------------------------------------------------------------------
 //  Memory
@@ -77,39 +78,4 @@ static inline f32 clamp_f(f32 v, f32 lo, f32 hi)
     return fminf(fmaxf(v, lo), hi);
 }
 
-// ------------------------------------------------------------------------------------------------
-//  Timer
-//
-
-typedef struct {
-    f64 start_time;
-    f64 lifetime;
-} Timer;
-
-static void timer_start(Timer* t, const f64 start_time, const f64 lifetime)
-{
-    if (t->start_time != 0.0f || t->lifetime != 0.0f) {
-        return;
-    }
-    t->start_time = start_time;
-    t->lifetime = lifetime;
-}
-
-static void timer_stop(Timer* t)
-{
-    t->start_time = 0.0f;
-    t->lifetime = 0.0f;
-}
-
-static bool timer_done(Timer* t, const f64 now)
-{
-    return now - t->start_time >= t->lifetime;
-}
-
-static f64 timer_get_elapsed(Timer* t, const f64 now)
-{
-    f64 elapsed = now - t->start_time;
-    return elapsed < 0 ? 0 : elapsed;
-}
-
 #endif // UTILS_H_
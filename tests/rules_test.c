@@ -0,0 +1,196 @@
+#include "rules.h"
+#include "test.h"
+
+#define INTERVAL_MS 100
+
+static TuningData tuning;
+
+static Rules step(const Rules* rules, u8 pressed, u32 dt_ms);
+static Rules show_level(Rules rules);
+static Rules play_level(Rules rules);
+static void test_deal(void);
+static void test_show(void);
+static void test_levels_to_win(void);
+static void test_wrong_press(void);
+static void test_out_of_phase(void);
+
+int main(void)
+{
+    tuning = *tuning_defaults();
+    tuning.n_levels = 2;
+    tuning.levels[0] = (TuningLevel){.moves = 2, .show_interval_ms = INTERVAL_MS};
+    tuning.levels[1] = (TuningLevel){.moves = 3, .show_interval_ms = INTERVAL_MS};
+
+    test_deal();
+    test_show();
+    test_levels_to_win();
+    test_wrong_press();
+    test_out_of_phase();
+
+    return TEST_RESULT("rules");
+}
+
+// ------------------------------------------------------------------------------------------------
+
+static Rules step(const Rules* rules, u8 pressed, u32 dt_ms)
+{
+    return rules_step(rules, (RulesInput){.pressed = pressed}, dt_ms, &tuning);
+}
+
+static Rules show_level(Rules rules)
+{
+    while (rules.phase == RULES_SHOW) {
+        rules = step(&rules, RULES_NO_QUAD, rules.timer_ms);
+    }
+    return rules;
+}
+
+// Repeats the sequence back correctly, returning the state after the level's last press
+static Rules play_level(Rules rules)
+{
+    rules = show_level(rules);
+    EXPECT(rules.phase == RULES_INPUT);
+
+    u8 level = rules.level;
+    while (rules.phase == RULES_INPUT && rules.level == level) {
+        u8 quad = rules.seq.quads[rules.pos];
+        rules = step(&rules, quad, 16);
+        EXPECT(rules.events & RULES_EV_PRESS);
+        EXPECT(rules.lit == quad);
+    }
+    return rules;
+}
+
+static void test_deal(void)
+{
+    Rules a;
+    rules_seed(&a, 1234);
+    EXPECT(a.phase == RULES_IDLE);
+
+    rules_new_game(&a);
+    EXPECT(a.phase == RULES_DEAL);
+    a = step(&a, RULES_NO_QUAD, 0);
+    EXPECT(a.phase == RULES_SHOW);
+    EXPECT(a.events == RULES_EV_LEVEL);
+    EXPECT(a.level == 1);
+    EXPECT(a.seq.n_quads == 2);
+    EXPECT(a.timer_ms == INTERVAL_MS);
+    EXPECT(a.lit == RULES_NO_QUAD);
+    for (size_t i = 0; i < a.seq.n_quads; ++i) {
+        EXPECT(a.seq.quads[i] < RULES_QUADS);
+    }
+
+    // The same seed deals the same game
+    Rules b;
+    rules_seed(&b, 1234);
+    rules_new_game(&b);
+    b = step(&b, RULES_NO_QUAD, 0);
+    EXPECT(b.seq.n_quads == a.seq.n_quads);
+    for (size_t i = 0; i < a.seq.n_quads; ++i) {
+        EXPECT(b.seq.quads[i] == a.seq.quads[i]);
+    }
+}
+
+static void test_show(void)
+{
+    Rules r;
+    rules_seed(&r, 7);
+    rules_new_game(&r);
+    r = step(&r, RULES_NO_QUAD, 0);
+
+    // Nothing lights before the interval is up, and presses during playback are ignored
+    r = step(&r, r.seq.quads[0], INTERVAL_MS - 1);
+    EXPECT(r.events == 0);
+    EXPECT(r.lit == RULES_NO_QUAD);
+
+    r = step(&r, RULES_NO_QUAD, 1);
+    EXPECT(r.events == RULES_EV_LIGHT);
+    EXPECT(r.lit == r.seq.quads[0]);
+    EXPECT(r.timer_ms == INTERVAL_MS);
+
+    r = step(&r, RULES_NO_QUAD, INTERVAL_MS);
+    EXPECT(r.events == RULES_EV_LIGHT);
+    EXPECT(r.lit == r.seq.quads[1]);
+
+    r = step(&r, RULES_NO_QUAD, INTERVAL_MS);
+    EXPECT(r.events == RULES_EV_INPUT);
+    EXPECT(r.phase == RULES_INPUT);
+    EXPECT(r.lit == RULES_NO_QUAD);
+    EXPECT(r.pos == 0);
+
+    // Waiting changes nothing; a press is only lit for its own step
+    r = step(&r, RULES_NO_QUAD, 5000);
+    EXPECT(r.events == 0);
+    EXPECT(r.phase == RULES_INPUT);
+    r = step(&r, r.seq.quads[0], 16);
+    EXPECT(r.lit == r.seq.quads[0]);
+    r = step(&r, RULES_NO_QUAD, 16);
+    EXPECT(r.lit == RULES_NO_QUAD);
+    EXPECT(r.pos == 1);
+}
+
+static void test_levels_to_win(void)
+{
+    Rules r;
+    rules_seed(&r, 99);
+    rules_new_game(&r);
+    r = step(&r, RULES_NO_QUAD, 0);
+
+    r = play_level(r);
+    EXPECT(r.events == (RULES_EV_PRESS | RULES_EV_LEVEL));
+    EXPECT(r.phase == RULES_SHOW);
+    EXPECT(r.level == 2);
+    EXPECT(r.seq.n_quads == 3);
+    EXPECT(r.pos == 0);
+
+    // The next level starts dark even though the deciding press was lit
+    r = step(&r, RULES_NO_QUAD, 1);
+    EXPECT(r.lit == RULES_NO_QUAD);
+
+    r = play_level(r);
+    EXPECT(r.events == (RULES_EV_PRESS | RULES_EV_WON));
+    EXPECT(r.phase == RULES_WON);
+
+    // A decided game no longer moves
+    Rules after = step(&r, RULES_NO_QUAD, INTERVAL_MS);
+    EXPECT(after.phase == RULES_WON);
+    EXPECT(after.events == 0);
+}
+
+static void test_wrong_press(void)
+{
+    Rules r;
+    rules_seed(&r, 3);
+    rules_new_game(&r);
+    r = show_level(step(&r, RULES_NO_QUAD, 0));
+
+    u8 wrong = (u8)((r.seq.quads[0] + 1) % RULES_QUADS);
+    r = step(&r, wrong, 16);
+    EXPECT(r.events == (RULES_EV_PRESS | RULES_EV_LOST));
+    EXPECT(r.phase == RULES_LOST);
+    EXPECT(r.lit == wrong);
+}
+
+// The single transitions leave a game alone outside their own phase
+static void test_out_of_phase(void)
+{
+    Rules r;
+    rules_seed(&r, 5);
+    rules_new_game(&r);
+    rules_deal(&r, &tuning);
+    EXPECT(r.phase == RULES_SHOW);
+
+    Rules before = r;
+    rules_press(&r, r.seq.quads[0], &tuning);
+    EXPECT(r.events == 0);
+    EXPECT(r.phase == before.phase && r.pos == before.pos && r.lit == before.lit);
+
+    rules_deal(&r, &tuning);
+    EXPECT(r.events == 0);
+    EXPECT(r.level == before.level);
+
+    r = show_level(r);
+    rules_show_next(&r, &tuning);
+    EXPECT(r.events == 0);
+    EXPECT(r.phase == RULES_INPUT);
+}
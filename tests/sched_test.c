@@ -0,0 +1,123 @@
+#include "sched.h"
+#include "test.h"
+
+#define MAX_FIRED 16
+
+typedef struct {
+    u32 id;
+    u64 at;
+} Fired;
+
+static Scheduler sched;
+static Fired fired[MAX_FIRED];
+static u32 n_fired;
+static SchedTimer victim;
+
+static void record(void* user);
+static void cancel_victim(void* user);
+static void reschedule(void* user);
+static void test_order_across_levels(void);
+static void test_generation_reuse(void);
+static void test_cancel_in_callback(void);
+
+int main(void)
+{
+    test_order_across_levels();
+    test_generation_reuse();
+    test_cancel_in_callback();
+
+    return TEST_RESULT("sched");
+}
+
+// ------------------------------------------------------------------------------------------------
+
+static void record(void* user)
+{
+    if (n_fired < MAX_FIRED) {
+        fired[n_fired++] = (Fired){.id = (u32)(uintptr_t)user, .at = sched.now};
+    }
+}
+
+static void cancel_victim(void* user)
+{
+    record(user);
+    EXPECT(sched_cancel(&sched, victim));
+}
+
+static void reschedule(void* user)
+{
+    record(user);
+    EXPECT(sched_after(&sched, 0, record, (void*)(uintptr_t)((uintptr_t)user + 1)) != 0);
+}
+
+// Deadlines on every level, scheduled out of order from an unaligned start, must each fire on
+// their exact tick after cascading down, and therefore in deadline order
+static void test_order_across_levels(void)
+{
+    static const u64 delays[] = {4100, 3, 70, 262200, 64, 4096, 63, 1};
+    const u32 n = sizeof(delays) / sizeof(delays[0]);
+    const u64 start = 10;
+
+    sched_init(&sched, start);
+    n_fired = 0;
+    for (u32 i = 0; i < n; ++i) {
+        EXPECT(sched_after(&sched, delays[i], record, (void*)(uintptr_t)i) != 0);
+    }
+
+    for (u64 now = start; now < start + 270000; now += 7) {
+        sched_advance(&sched, now);
+    }
+
+    EXPECT(n_fired == n);
+    EXPECT(sched.n_active == 0);
+    for (u32 i = 0; i < n_fired; ++i) {
+        EXPECT(fired[i].at == start + delays[fired[i].id]);
+        if (i > 0) {
+            EXPECT(fired[i].at >= fired[i - 1].at);
+        }
+    }
+}
+
+// A released node is handed out again under a new generation, so stale handles stay dead
+static void test_generation_reuse(void)
+{
+    sched_init(&sched, 0);
+    n_fired = 0;
+
+    SchedTimer first = sched_after(&sched, 5, record, (void*)1);
+    EXPECT(sched_cancel(&sched, first));
+    EXPECT(!sched_cancel(&sched, first));
+
+    SchedTimer second = sched_after(&sched, 5, record, (void*)2);
+    EXPECT((second & 0xffff) == (first & 0xffff));
+    EXPECT(second != first);
+    EXPECT(!sched_cancel(&sched, first));
+
+    sched_advance(&sched, 10);
+    EXPECT(n_fired == 1 && fired[0].id == 2);
+
+    // Firing releases the node too
+    EXPECT(!sched_cancel(&sched, second));
+    EXPECT(!sched_cancel(&sched, 0));
+}
+
+// Callbacks may cancel a timer due on the same tick and schedule new ones
+static void test_cancel_in_callback(void)
+{
+    sched_init(&sched, 0);
+    n_fired = 0;
+
+    // Slots are LIFO, so the victim is scheduled first to fire after its canceller
+    victim = sched_after(&sched, 3, record, (void*)1);
+    EXPECT(sched_after(&sched, 3, cancel_victim, (void*)2) != 0);
+    EXPECT(sched_after(&sched, 3, reschedule, (void*)3) != 0);
+
+    sched_advance(&sched, 3);
+    EXPECT(n_fired == 2);
+    EXPECT(sched.n_active == 1);
+
+    sched_advance(&sched, 4);
+    EXPECT(n_fired == 3);
+    EXPECT(fired[2].id == 4 && fired[2].at == 4);
+    EXPECT(sched.n_active == 0);
+}
@@ -0,0 +1,137 @@
+#include "snapshot.h"
+#include "test.h"
+#include <stdio.h>
+#include <string.h>
+
+#define TEST_PATH "tests/tests_snapshot.sav"
+#define TEST_VERSION 7
+
+typedef struct {
+    u32 a;
+    u8 bytes[61];
+    u64 b;
+} Block;
+
+static Block make_block(u32 seed);
+static bool rewrite_payload(long delta);
+static void test_round_trip(void);
+static void test_rejects(void);
+static void test_ring(void);
+
+int main(void)
+{
+    test_round_trip();
+    test_rejects();
+    test_ring();
+
+    remove(TEST_PATH);
+    return TEST_RESULT("snapshot");
+}
+
+// ------------------------------------------------------------------------------------------------
+
+static Block make_block(u32 seed)
+{
+    Block block;
+    memset(&block, 0, sizeof(block));
+    block.a = seed;
+    for (u32 i = 0; i < sizeof(block.bytes); ++i) {
+        block.bytes[i] = (u8)(seed * 31 + i);
+    }
+    block.b = (u64)seed << 40 | 0xabcdef;
+    return block;
+}
+
+// Rewrites the saved file with its payload shortened or padded by `delta` bytes
+static bool rewrite_payload(long delta)
+{
+    unsigned char buf[sizeof(SnapshotHeader) + sizeof(Block) + 16];
+    FILE* f = fopen(TEST_PATH, "rb");
+    if (!f) {
+        return false;
+    }
+    size_t n = fread(buf, 1, sizeof(buf), f);
+    fclose(f);
+
+    f = fopen(TEST_PATH, "wb");
+    if (!f) {
+        return false;
+    }
+    size_t len = (size_t)((long)n + delta);
+    if (delta > 0) {
+        memset(buf + n, 0, (size_t)delta);
+    }
+    bool ok = fwrite(buf, 1, len, f) == len;
+    return fclose(f) == 0 && ok;
+}
+
+static void test_round_trip(void)
+{
+    Block saved = make_block(42);
+    EXPECT(snapshot_save(TEST_PATH, &saved, sizeof(saved), TEST_VERSION));
+
+    Block loaded = make_block(0);
+    EXPECT(snapshot_load(TEST_PATH, &loaded, sizeof(loaded), TEST_VERSION));
+    EXPECT(memcmp(&saved, &loaded, sizeof(saved)) == 0);
+
+    // No temporary is left behind
+    FILE* tmp = fopen(TEST_PATH ".tmp", "rb");
+    EXPECT(!tmp);
+    if (tmp) {
+        fclose(tmp);
+    }
+}
+
+// Anything that doesn't match the block exactly fails and leaves the destination untouched
+static void test_rejects(void)
+{
+    const Block untouched = make_block(1);
+    Block saved = make_block(42);
+    Block dst;
+
+    EXPECT(snapshot_save(TEST_PATH, &saved, sizeof(saved), TEST_VERSION));
+    dst = untouched;
+    EXPECT(!snapshot_load(TEST_PATH, &dst, sizeof(dst), TEST_VERSION + 1));
+    EXPECT(!snapshot_load(TEST_PATH, &dst, sizeof(dst) - 8, TEST_VERSION));
+    EXPECT(memcmp(&dst, &untouched, sizeof(dst)) == 0);
+
+    EXPECT(rewrite_payload(-1));
+    EXPECT(!snapshot_load(TEST_PATH, &dst, sizeof(dst), TEST_VERSION));
+    EXPECT(memcmp(&dst, &untouched, sizeof(dst)) == 0);
+
+    EXPECT(snapshot_save(TEST_PATH, &saved, sizeof(saved), TEST_VERSION));
+    EXPECT(rewrite_payload(-(long)(sizeof(saved) + sizeof(SnapshotHeader) / 2)));
+    EXPECT(!snapshot_load(TEST_PATH, &dst, sizeof(dst), TEST_VERSION));
+
+    EXPECT(snapshot_save(TEST_PATH, &saved, sizeof(saved), TEST_VERSION));
+    EXPECT(rewrite_payload(3));
+    EXPECT(!snapshot_load(TEST_PATH, &dst, sizeof(dst), TEST_VERSION));
+    EXPECT(memcmp(&dst, &untouched, sizeof(dst)) == 0);
+
+    remove(TEST_PATH);
+    EXPECT(!snapshot_load(TEST_PATH, &dst, sizeof(dst), TEST_VERSION));
+}
+
+// Pops hand back the newest first, and a full ring overwrites its oldest slot
+static void test_ring(void)
+{
+    SnapshotRing ring;
+    EXPECT(snapshot_init(&ring, sizeof(Block), 2, "tests.ring", MEM_SUBSYS_GAME));
+
+    for (u32 i = 1; i <= 3; ++i) {
+        Block block = make_block(i);
+        snapshot_push(&ring, &block);
+    }
+
+    Block out;
+    EXPECT(snapshot_pop(&ring, &out) && out.a == 3 && out.b == make_block(3).b);
+    EXPECT(snapshot_pop(&ring, &out) && out.a == 2);
+    EXPECT(!snapshot_pop(&ring, &out));
+
+    Block block = make_block(9);
+    snapshot_push(&ring, &block);
+    snapshot_clear(&ring);
+    EXPECT(!snapshot_pop(&ring, &out));
+
+    snapshot_destroy(&ring);
+}
@@ -0,0 +1,21 @@
+#ifndef TEST_H_
+#define TEST_H_
+
+#include <stdio.h>
+
+// Minimal harness for the SDL-free core: a failed EXPECT reports and carries on, so one run lists
+// every broken behaviour, and TEST_RESULT turns the tally into the process exit status.
+static int test_failures;
+
+#define EXPECT(cond)                                                                                               \
+    do {                                                                                                           \
+        if (!(cond)) {                                                                                             \
+            fprintf(stderr, "%s:%d: expected %s\n", __FILE__, __LINE__, #cond);                                    \
+            test_failures++;                                                                                       \
+        }                                                                                                          \
+    } while (0)
+
+#define TEST_RESULT(name)                                                                                          \
+    (fprintf(stderr, "%s: %s\n", (name), test_failures ? "FAILED" : "ok"), test_failures ? 1 : 0)
+
+#endif // !TEST_H_
@@ -0,0 +1,80 @@
+#include "test.h"
+#include "tuning.h"
+#include <math.h>
+
+static void test_defaults(void);
+static void test_rejects(void);
+
+int main(void)
+{
+    test_defaults();
+    test_rejects();
+
+    return TEST_RESULT("tuning");
+}
+
+// ------------------------------------------------------------------------------------------------
+
+static void test_defaults(void)
+{
+    EXPECT(tuning_validate(tuning_defaults(), sizeof(TuningData)));
+}
+
+// Each case breaks one field of otherwise valid data; rejections log an error, which is expected
+static void test_rejects(void)
+{
+    const TuningData ok = *tuning_defaults();
+    TuningData d;
+
+    EXPECT(!tuning_validate(&ok, sizeof(TuningData) - 1));
+
+    d = ok, d.magic ^= 1;
+    EXPECT(!tuning_validate(&d, sizeof(d)));
+    d = ok, d.version += 1;
+    EXPECT(!tuning_validate(&d, sizeof(d)));
+    d = ok, d.size -= 4;
+    EXPECT(!tuning_validate(&d, sizeof(d)));
+
+    d = ok, d.max_moves = 0;
+    EXPECT(!tuning_validate(&d, sizeof(d)));
+    d = ok, d.max_moves = TUNING_MAX_MOVES + 1;
+    EXPECT(!tuning_validate(&d, sizeof(d)));
+
+    d = ok, d.pulse_secs = 0.0f;
+    EXPECT(!tuning_validate(&d, sizeof(d)));
+    d = ok, d.pulse_secs = NAN;
+    EXPECT(!tuning_validate(&d, sizeof(d)));
+    d = ok, d.tone_secs = TUNING_MAX_EFFECT_SECS * 2.0f;
+    EXPECT(!tuning_validate(&d, sizeof(d)));
+
+    d = ok, d.colours[2].g = 1.5f;
+    EXPECT(!tuning_validate(&d, sizeof(d)));
+    d = ok, d.hi_colours[0].a = -0.1f;
+    EXPECT(!tuning_validate(&d, sizeof(d)));
+    d = ok, d.colours[3].r = NAN;
+    EXPECT(!tuning_validate(&d, sizeof(d)));
+
+    d = ok, d.n_levels = 0;
+    EXPECT(!tuning_validate(&d, sizeof(d)));
+    d = ok, d.n_levels = TUNING_MAX_LEVELS + 1;
+    EXPECT(!tuning_validate(&d, sizeof(d)));
+
+    d = ok, d.levels[0].moves = 0;
+    EXPECT(!tuning_validate(&d, sizeof(d)));
+    d = ok, d.levels[d.n_levels - 1].moves = d.max_moves + 1;
+    EXPECT(!tuning_validate(&d, sizeof(d)));
+    d = ok, d.levels[0].show_interval_ms = TUNING_MIN_SHOW_INTERVAL_MS - 1;
+    EXPECT(!tuning_validate(&d, sizeof(d)));
+
+    // Levels past n_levels are not in play, so they are not checked
+    d = ok;
+    if (d.n_levels < TUNING_MAX_LEVELS) {
+        d.levels[d.n_levels].moves = 0;
+        EXPECT(tuning_validate(&d, sizeof(d)));
+    }
+
+    // The bounds themselves are allowed
+    d = ok, d.pulse_secs = TUNING_MAX_EFFECT_SECS, d.colours[1].b = 0.0f, d.hi_colours[1].b = 1.0f;
+    d.levels[0].show_interval_ms = TUNING_MIN_SHOW_INTERVAL_MS;
+    EXPECT(tuning_validate(&d, sizeof(d)));
+}
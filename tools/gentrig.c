@@ -0,0 +1,77 @@
+// Build-time generator for the unit-arc tables gfx.c's fixed-count kernels read instead of calling
+// cosf/sinf per vertex.
+//
+//     gentrig src/trig_tables.h
+//
+// Each table holds cos and sin of i/n * span for i = 0..n, computed in double precision. Add a row
+// to `tables` for any new segment count the renderer should specialise.
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+typedef struct {
+    const char* name;
+    unsigned segments;
+    double span;
+} TrigTable;
+
+// CIRCLE serves the 40-per-quarter sectors: a quarter starting on a multiple of pi/2 is a window of
+// 41 consecutive entries. RING is the 200-segment outline.
+static const TrigTable tables[] = {
+    {"CIRCLE", 160, 2.0 * M_PI},
+    {"RING", 200, 2.0 * M_PI},
+};
+
+static void write_row(FILE* out, const char* name, const char* fn, const TrigTable* t);
+
+int main(int argc, char** argv)
+{
+    if (argc != 2) {
+        fprintf(stderr, "usage: %s <trig_tables.h>\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    FILE* out = fopen(argv[1], "w");
+    if (!out) {
+        fprintf(stderr, "can't open '%s'\n", argv[1]);
+        return EXIT_FAILURE;
+    }
+
+    fprintf(out, "// Generated by tools/gentrig.c - do not edit\n\n");
+    fprintf(out, "#ifndef TRIG_TABLES_H_\n#define TRIG_TABLES_H_\n\n");
+
+    for (size_t i = 0; i < sizeof(tables) / sizeof(tables[0]); ++i) {
+        const TrigTable* t = &tables[i];
+        fprintf(out, "#define TRIG_%s_SEGS %u\n", t->name, t->segments);
+        fprintf(out, "#define TRIG_%s_SPAN %.9ef\n\n", t->name, t->span);
+        write_row(out, t->name, "COS", t);
+        write_row(out, t->name, "SIN", t);
+    }
+
+    fprintf(out, "#endif // !TRIG_TABLES_H_\n");
+
+    if (fclose(out) != 0) {
+        fprintf(stderr, "error writing '%s'\n", argv[1]);
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+static void write_row(FILE* out, const char* name, const char* fn, const TrigTable* t)
+{
+    fprintf(out, "static const float TRIG_%s_%s[%u] = {", name, fn, t->segments + 1);
+    for (unsigned i = 0; i <= t->segments; ++i) {
+        double a = (double)i / t->segments * t->span;
+        double v = fn[0] == 'C' ? cos(a) : sin(a);
+        fprintf(out, "%s%.9ef,", i % 4 ? " " : "\n    ", v);
+    }
+    fprintf(out, "\n};\n\n");
+}
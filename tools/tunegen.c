@@ -0,0 +1,130 @@
+// Offline converter from the text tuning source to the binary image the game mmaps.
+//
+//     tunegen assets/tuning.txt assets/tuning.bin
+//
+// Output is written to <out>.tmp and renamed into place so a running game never maps a partial
+// file. Each non-empty line is a directive; '#' starts a comment.
+//
+//     max_moves <n>
+//     pulse_secs <secs>
+//     tone_secs <secs>
+//     colour <quad> <r> <g> <b> <a>
+//     hi_colour <quad> <r> <g> <b> <a>
+//     level <moves> <show_interval_ms>
+
+#include "tuning.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static bool parse_colour(const char* args, TuningColour* colours, unsigned lnum);
+
+int main(int argc, char** argv)
+{
+    if (argc != 3) {
+        fprintf(stderr, "usage: %s <tuning.txt> <tuning.bin>\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    FILE* in = fopen(argv[1], "r");
+    if (!in) {
+        fprintf(stderr, "can't open '%s'\n", argv[1]);
+        return EXIT_FAILURE;
+    }
+
+    // Start from the built-in values so the text file only needs to override what it changes
+    TuningData data = *tuning_defaults();
+    bool levels_seen = false;
+
+    char line[512];
+    unsigned lnum = 0;
+    bool ok = true;
+
+    while (ok && fgets(line, sizeof(line), in)) {
+        ++lnum;
+
+        char* hash = strchr(line, '#');
+        if (hash) *hash = '\0';
+
+        char key[32];
+        int consumed = 0;
+        if (sscanf(line, "%31s%n", key, &consumed) != 1) {
+            continue;
+        }
+        const char* args = line + consumed;
+
+        if (strcmp(key, "max_moves") == 0) {
+            ok = sscanf(args, "%u", &data.max_moves) == 1;
+        } else if (strcmp(key, "pulse_secs") == 0) {
+            ok = sscanf(args, "%f", &data.pulse_secs) == 1;
+        } else if (strcmp(key, "tone_secs") == 0) {
+            ok = sscanf(args, "%f", &data.tone_secs) == 1;
+        } else if (strcmp(key, "colour") == 0) {
+            ok = parse_colour(args, data.colours, lnum);
+        } else if (strcmp(key, "hi_colour") == 0) {
+            ok = parse_colour(args, data.hi_colours, lnum);
+        } else if (strcmp(key, "level") == 0) {
+            // The first level line discards the built-in table
+            if (!levels_seen) {
+                memset(data.levels, 0, sizeof(data.levels));
+                data.n_levels = 0;
+                levels_seen = true;
+            }
+            if (data.n_levels >= TUNING_MAX_LEVELS) {
+                fprintf(stderr, "%s:%u: more than %d levels\n", argv[1], lnum, TUNING_MAX_LEVELS);
+                ok = false;
+                break;
+            }
+            TuningLevel* level = &data.levels[data.n_levels++];
+            ok = sscanf(args, "%u %u", &level->moves, &level->show_interval_ms) == 2;
+        } else {
+            fprintf(stderr, "%s:%u: unknown directive '%s'\n", argv[1], lnum, key);
+            ok = false;
+            break;
+        }
+
+        if (!ok) {
+            fprintf(stderr, "%s:%u: malformed '%s' line\n", argv[1], lnum, key);
+        }
+    }
+    fclose(in);
+
+    if (!ok || !tuning_validate(&data, sizeof(data))) {
+        return EXIT_FAILURE;
+    }
+
+    char tmp[FPATH_MAX];
+    snprintf(tmp, sizeof(tmp), "%s.tmp", argv[2]);
+
+    FILE* out = fopen(tmp, "wb");
+    if (!out) {
+        fprintf(stderr, "can't open '%s'\n", tmp);
+        return EXIT_FAILURE;
+    }
+    bool written = fwrite(&data, sizeof(data), 1, out) == 1;
+    written = fclose(out) == 0 && written;
+
+    if (!written || rename(tmp, argv[2]) != 0) {
+        fprintf(stderr, "can't write '%s'\n", argv[2]);
+        remove(tmp);
+        return EXIT_FAILURE;
+    }
+
+    printf("%s: %u levels, %zu bytes\n", argv[2], data.n_levels, sizeof(data));
+
+    return EXIT_SUCCESS;
+}
+
+static bool parse_colour(const char* args, TuningColour* colours, unsigned lnum)
+{
+    unsigned quad;
+    TuningColour c;
+
+    if (sscanf(args, "%u %f %f %f %f", &quad, &c.r, &c.g, &c.b, &c.a) != 5 || quad >= TUNING_QUADS) {
+        fprintf(stderr, "line %u: expected <quad 0-%d> <r> <g> <b> <a>\n", lnum, TUNING_QUADS - 1);
+        return false;
+    }
+    colours[quad] = c;
+
+    return true;
+}